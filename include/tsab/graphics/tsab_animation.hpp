@@ -3,6 +3,14 @@
 
 #include <tsab/tsab_common.hpp>
 
+typedef struct AsepriteSheet AsepriteSheet;
+
+// Only touches the cpu side, so it can be called from any thread
+AsepriteSheet* tsab_animation_decode(const char* path);
+void tsab_animation_free_sheet(AsepriteSheet* sheet);
+// Uploads the sheet and wraps it into an AnimationData instance (frees the sheet)
+LitValue tsab_animation_data_new(LitVm* vm, AsepriteSheet* sheet);
+
 void tsab_animation_bind_api(LitState* state);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef TSAB_ATLAS_HPP
+#define TSAB_ATLAS_HPP
+
+#include <tsab/tsab_common.hpp>
+
+#include <SDL.h>
+#include "SDL_gpu.h"
+
+#define ATLAS_PAGE_SIZE 2048
+// Anything bigger than this gets its own texture, so that a few huge images don't eat whole pages
+#define ATLAS_MAX_SIZE 1024
+
+typedef struct {
+	GPU_Image* texture;
+	int texture_id;
+
+	uint16_t x;
+	uint16_t y;
+	uint16_t w;
+	uint16_t h;
+} AtlasRegion;
+
+// Copies the surface into one of the shared pages, returns false if it's too big to be packed
+bool tsab_atlas_pack(SDL_Surface* surface, AtlasRegion* region);
+// Packs the surface if possible, or uploads it as a standalone image otherwise
+bool tsab_atlas_add(SDL_Surface* surface, AtlasRegion* region);
+bool tsab_atlas_load(const char* path, AtlasRegion* region);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef TSAB_BATCH_HPP
+#define TSAB_BATCH_HPP
+
+#include <tsab/tsab_common.hpp>
+
+#include <SDL.h>
+#include "SDL_gpu.h"
+
+#include <vector>
+
+// x, y, s, t, r, g, b, a
+#define BATCH_VERTEX_SIZE 8
+// GPU_TriangleBatch takes the vertex count as an unsigned short
+#define BATCH_MAX_QUADS 16383
+
+typedef struct QuadBatch {
+	GPU_Image* texture;
+	std::vector<float> vertices;
+	uint count;
+} QuadBatch;
+
+void tsab_batch_begin(QuadBatch* batch, GPU_Image* texture);
+void tsab_batch_add(QuadBatch* batch, const GPU_Rect* src, float x, float y, float ox, float oy, float a, float sx, float sy, SDL_Color color);
+void tsab_batch_draw(QuadBatch* batch, GPU_Target* target);
+void tsab_batch_flush(QuadBatch* batch, GPU_Target* target);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef TSAB_COLOR_HPP
+#define TSAB_COLOR_HPP
+
+#include <tsab/tsab_common.hpp>
+
+#include <SDL.h>
+
+// Packed colors are plain numbers, 0xRRGGBBAA with bit 32 set, so that they never look like a gray value
+#define COLOR_TAG 4294967296.0
+#define COLOR_CACHE_SIZE 64
+// #rrggbbaa
+#define COLOR_MAX_LENGTH 9
+
+double tsab_color_pack(SDL_Color color);
+SDL_Color tsab_color_unpack(double packed);
+bool tsab_color_is_packed(LitValue value);
+
+// Accepts rgb, rrggbb and rrggbbaa, with or without the #
+bool tsab_color_parse_hex(const char* string, uint length, SDL_Color* out);
+// Parses every string only once, repeated lookups go by the interned string object
+bool tsab_color_from_string(LitString* string, SDL_Color* out);
+// A packed color, a hex string, an array, gray (and alpha) or r, g, b (and a), returns false if nothing was read
+bool tsab_color_read(LitVm* vm, uint arg_count, LitValue* args, SDL_Color* out);
+
+void tsab_color_bind_api(LitState* state);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef TSAB_FONT_HPP
+#define TSAB_FONT_HPP
+
+#include <tsab/tsab_common.hpp>
+
+#include <SDL_ttf.h>
+#include "SDL_gpu.h"
+
+typedef struct FontAtlas FontAtlas;
+
+FontAtlas* tsab_font_new(TTF_Font* font);
+void tsab_font_free(FontAtlas* atlas);
+
+void tsab_font_measure(FontAtlas* atlas, const char* text, float wrap, float* width, float* height);
+void tsab_font_print(FontAtlas* atlas, GPU_Target* target, const char* text, float x, float y, float wrap, float r, float sx, float sy, SDL_Color color);
+
+// Renders the text in white into a new image, that can later be tinted with GPU_SetRGBA
+GPU_Image* tsab_font_bake(FontAtlas* atlas, const char* text, float wrap);
+
+#endif
\ No newline at end of file
@@ -2,11 +2,13 @@
 #define TSAB_GRAPHICS_HPP
 
 #include <tsab/tsab_common.hpp>
+#include <tsab/graphics/tsab_font.hpp>
 
 #include <SDL.h>
 #include "SDL_gpu.h"
 
-bool tsab_graphics_init(LitState* state, LitInstance* config);
+// Without a window nothing gets created, and draw calls are only counted
+bool tsab_graphics_init(LitState* state, LitInstance* config, bool no_window);
 void tsab_graphics_handle_event(SDL_Event* event);
 void tsab_graphics_get_ready();
 void tsab_graphics_quit();
@@ -18,6 +20,12 @@ void tsab_graphics_begin_frame(float dt);
 void tsab_graphics_finish_frame();
 GPU_Image* tsab_graphics_get_image(int id);
 int tsab_graphics_add_image(GPU_Image* image);
+SDL_Color tsab_graphics_get_color();
+// The world area, that the current camera shows on the current target
+GPU_Rect tsab_graphics_get_visible_rect();
+FontAtlas* tsab_graphics_get_font();
+bool tsab_graphics_is_headless();
+void tsab_graphics_count_draw();
 
 void tsab_graphics_bind_api(LitState* state);
 
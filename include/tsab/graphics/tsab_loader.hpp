@@ -0,0 +1,14 @@
+#ifndef TSAB_LOADER_HPP
+#define TSAB_LOADER_HPP
+
+#include <tsab/tsab_common.hpp>
+
+// Decode the file on a worker thread, the callback gets the image id / AnimationData (or null) once it's uploaded
+void tsab_loader_load_image(LitVm* vm, const char* path, LitValue callback);
+void tsab_loader_load_aseprite(LitVm* vm, const char* path, LitValue callback);
+
+// Uploads finished images and calls their callbacks, called at the start of every frame
+void tsab_loader_update(LitState* state);
+void tsab_loader_quit();
+
+#endif
\ No newline at end of file
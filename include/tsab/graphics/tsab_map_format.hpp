@@ -0,0 +1,68 @@
+#ifndef TSAB_MAP_FORMAT_HPP
+#define TSAB_MAP_FORMAT_HPP
+
+#include <cstdint>
+
+/*
+ * Binary map layout, written by util/mapconvert and memory-mapped by the Tilemap as-is.
+ * Everything is stored in the native (little-endian) byte order, and all offsets are in bytes from the start of the file.
+ *
+ * [header] [tilesets] [layers] [objects] [tiles of every layer, width * height uint32 gids each] [string pool]
+ */
+
+#define TSAB_MAP_MAGIC 0x50414D54 // TMAP
+#define TSAB_MAP_VERSION 1
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+
+	uint32_t width;
+	uint32_t height;
+	uint32_t tile_width;
+	uint32_t tile_height;
+
+	uint32_t tileset_count;
+	uint32_t layer_count;
+	uint32_t object_count;
+
+	uint32_t tilesets_offset;
+	uint32_t layers_offset;
+	uint32_t objects_offset;
+	uint32_t strings_offset;
+	uint32_t strings_size;
+} MapFileHeader;
+
+// Strings are offsets into the string pool, pointing at null-terminated strings
+typedef struct {
+	uint32_t name;
+	uint32_t image;
+
+	uint32_t first_gid;
+	uint32_t tile_count;
+	uint32_t columns;
+	uint32_t tile_width;
+	uint32_t tile_height;
+	uint32_t margin;
+	uint32_t spacing;
+} MapFileTileset;
+
+typedef struct {
+	uint32_t name;
+	uint32_t visible;
+	uint32_t data_offset;
+} MapFileLayer;
+
+// Objects are stored grouped by their layer, in the order Tiled has them
+typedef struct {
+	uint32_t layer;
+	uint32_t name;
+	uint32_t type;
+
+	float x;
+	float y;
+	float width;
+	float height;
+} MapFileObject;
+
+#endif
\ No newline at end of file
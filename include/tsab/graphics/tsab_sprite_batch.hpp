@@ -0,0 +1,8 @@
+#ifndef TSAB_SPRITE_BATCH_HPP
+#define TSAB_SPRITE_BATCH_HPP
+
+#include <tsab/tsab_common.hpp>
+
+void tsab_sprite_batch_bind_api(LitState* state);
+
+#endif
\ No newline at end of file
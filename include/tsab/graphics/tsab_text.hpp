@@ -0,0 +1,15 @@
+#ifndef TSAB_TEXT_HPP
+#define TSAB_TEXT_HPP
+
+#include <tsab/tsab_common.hpp>
+#include <tsab/graphics/tsab_font.hpp>
+
+#include "SDL_gpu.h"
+
+void tsab_text_quit();
+void tsab_text_bind_api(LitState* state);
+
+bool tsab_text_cache_draw(FontAtlas* font, GPU_Target* target, const char* text, float x, float y, float wrap, float r, float sx, float sy, SDL_Color color);
+void tsab_text_cache_set_budget(size_t bytes);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef TSAB_CONTACTS_HPP
+#define TSAB_CONTACTS_HPP
+
+#include <tsab/tsab_common.hpp>
+
+#include <box2d/box2d.h>
+
+#include <vector>
+#include <unordered_map>
+
+typedef enum {
+	CONTACT_BEGIN,
+	CONTACT_END,
+	CONTACT_PRE_SOLVE
+} ContactType;
+
+typedef struct {
+	ContactType type;
+
+	// Set to nullptr, if the body got collected before the event was delivered
+	LitInstance* a;
+	LitInstance* b;
+
+	b2Vec2 normal; // From a to b
+	b2Vec2 point;
+	float impulse;
+} ContactEvent;
+
+// Only records the events, the scripts get them after the step, outside of the solver
+class ContactListener : public b2ContactListener {
+	public:
+		std::vector<ContactEvent> events;
+		bool record_pre_solve = false;
+
+		void BeginContact(b2Contact* contact);
+		void EndContact(b2Contact* contact);
+		void PreSolve(b2Contact* contact, const b2Manifold* old_manifold);
+		void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse);
+
+		void clear();
+		void forget(LitInstance* instance);
+
+	private:
+		// The last event of every contact in this step, so that PostSolve can fill in the impulse
+		std::unordered_map<b2Contact*, uint> last_events;
+
+		void record(ContactType type, b2Contact* contact);
+};
+
+#endif
\ No newline at end of file
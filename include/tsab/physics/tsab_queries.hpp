@@ -0,0 +1,59 @@
+#ifndef TSAB_QUERIES_HPP
+#define TSAB_QUERIES_HPP
+
+#include <box2d/box2d.h>
+
+#include <vector>
+
+typedef struct {
+	b2Body* body;
+	b2Vec2 point;
+	b2Vec2 normal;
+	float fraction;
+} RayHit;
+
+/*
+ * Sensors and bodies without an instance are ignored by all of the queries
+ */
+
+class ClosestRayCallback : public b2RayCastCallback {
+	public:
+		RayHit hit;
+		bool found = false;
+
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction);
+};
+
+class AllRayCallback : public b2RayCastCallback {
+	public:
+		std::vector<RayHit>* hits;
+
+		float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction);
+};
+
+class FixtureQueryCallback : public b2QueryCallback {
+	public:
+		std::vector<b2Fixture*>* fixtures;
+
+		bool ReportFixture(b2Fixture* fixture);
+};
+
+class BodyQueryCallback : public b2QueryCallback {
+	public:
+		std::vector<b2Body*>* bodies;
+		// Only for point queries, the AABB alone is too rough
+		bool test_point = false;
+		b2Vec2 point;
+
+		bool ReportFixture(b2Fixture* fixture);
+};
+
+bool tsab_queries_raycast(b2World* world, b2Vec2 from, b2Vec2 to, RayHit* hit);
+// The hits are sorted by their distance
+void tsab_queries_raycast_all(b2World* world, b2Vec2 from, b2Vec2 to, std::vector<RayHit>* hits);
+// Sweeps a circle from one point to the other, the hit point is on the surface of the fixture, that got hit
+bool tsab_queries_circle_cast(b2World* world, b2Vec2 from, b2Vec2 to, float radius, RayHit* hit);
+void tsab_queries_query_aabb(b2World* world, b2AABB aabb, std::vector<b2Body*>* bodies);
+void tsab_queries_query_point(b2World* world, b2Vec2 point, std::vector<b2Body*>* bodies);
+
+#endif
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <tsab/tsab_common.hpp>
 
-bool tsab_init(bool debug);
+bool tsab_init(bool debug, bool headless);
 void tsab_quit();
 
 void tsab_setup_loop();
@@ -12,11 +12,19 @@ bool tsab_frame();
 
 float tsab_get_dt();
 LitState* tsab_get_state();
+LitInstance* tsab_get_instance();
+// True once a script error was handed to tsab.handleError
+bool tsab_had_error();
 
 void tsab_error(const char* message);
 void tsab_fatal_error(const char* message);
 
 void tsab_call_method(const char* name, LitValue* args, uint arg_count);
+// For hot callbacks, the name should be interned once and kept alive
+void tsab_call_method(LitString* name, LitValue* args, uint arg_count);
 bool tsab_handle_call(LitInterpretResult result);
 
+// Roots the object until the state is freed, scripts can't reach it through this
+void tsab_keep_alive(LitObject* object);
+
 #endif
\ No newline at end of file
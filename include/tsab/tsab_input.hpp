@@ -4,6 +4,8 @@
 #include <SDL.h>
 #include "lit.hpp"
 
+#include <vector>
+
 #define MOUSE_1 0
 #define MOUSE_2 1
 #define MOUSE_3 2
@@ -14,9 +16,69 @@
 #define MOUSE_WHEEL_LEFT 7
 #define MOUSE_WHEEL_RIGHT 8
 
+typedef enum {
+	INPUT_KEYBOARD,
+	INPUT_MOUSE,
+	INPUT_CONTROLLER,
+	INPUT_AXIS
+} InputDevice;
+
+// Input.key() hands out indices of these, so that polling doesn't have to look up the name
+typedef struct {
+	InputDevice device;
+	int code;
+} InputKey;
+
+#define INPUT_MAX_CONTROLLERS 4
+
+typedef struct {
+	Uint8 buttons[SDL_CONTROLLER_BUTTON_MAX];
+	Sint16 axes[SDL_CONTROLLER_AXIS_MAX];
+} ControllerState;
+
+// The slot index is the player number
+typedef struct {
+	SDL_GameController* controller;
+	SDL_JoystickID id;
+
+	// Kept up to date by the events, copied into current once per frame
+	ControllerState live;
+	ControllerState current;
+	ControllerState previous;
+} ControllerSlot;
+
+// Has to be a power of two, older events get overwritten
+#define INPUT_EVENT_BUFFER_SIZE 256
+
+typedef struct {
+	Uint32 time; // SDL ticks, ms
+	uint16_t key; // Key handle
+	int8_t player; // -1 for the keyboard and the mouse
+	bool pressed;
+} InputEvent;
+
+// Action state is kept in bitsets of this size
+#define INPUT_MAX_ACTIONS 128
+#define INPUT_DEFAULT_DEADZONE 0.25f
+
+typedef struct {
+	InputKey key;
+	// Axes only, 1 or -1 counts only that direction, 0 both
+	int direction;
+} ActionBinding;
+
+typedef struct {
+	std::vector<ActionBinding> bindings;
+	float deadzone;
+	float value;
+	// Controller slot to read, -1 for any
+	int player;
+} InputAction;
+
 void tsab_input_init();
 void tsab_input_quit();
 void tsab_input_bind_api(LitState* state);
+// Snapshots the devices and updates the actions, has to run after the events of the frame were handled
 void tsab_input_update();
 void tsab_input_handle_event(SDL_Event* event);
 
@@ -0,0 +1,41 @@
+#ifndef TSAB_PROFILER_HPP
+#define TSAB_PROFILER_HPP
+
+#include <tsab/tsab_common.hpp>
+
+// How many frames are kept in the history
+#define PROFILER_FRAMES 240
+#define PROFILER_MAX_SCOPES 32
+
+typedef enum {
+	PROFILER_EVENTS,
+	PROFILER_LOADER,
+	PROFILER_UPDATE,
+	PROFILER_PHYSICS, // Part of update
+	PROFILER_RENDER,
+	PROFILER_FLIP,
+	PROFILER_SLEEP,
+	PROFILER_FRAME,
+
+	PROFILER_PHASE_COUNT
+} ProfilerPhase;
+
+void tsab_profiler_begin_frame();
+void tsab_profiler_end_frame();
+
+void tsab_profiler_begin(ProfilerPhase phase);
+void tsab_profiler_end(ProfilerPhase phase);
+
+/*
+ * Entries are the phases first, followed by the scopes, that were opened from lit
+ */
+int tsab_profiler_get_entry_count();
+const char* tsab_profiler_get_entry_name(int entry);
+// Average time in ms over the last frames
+float tsab_profiler_get_average(int entry, int frames);
+// Fills the last count frames (oldest first), returns how many were written
+int tsab_profiler_get_history(int entry, float* out, int count);
+
+void tsab_profiler_bind_api(LitState* state);
+
+#endif
\ No newline at end of file
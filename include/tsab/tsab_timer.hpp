@@ -0,0 +1,40 @@
+#ifndef TSAB_TIMER_HPP
+#define TSAB_TIMER_HPP
+
+#include <tsab/tsab_common.hpp>
+
+// The last few ms of a wait are spent spinning, because SDL_Delay tends to oversleep
+#define TIMER_SPIN_MS 2
+#define TIMER_DEFAULT_FPS 60
+
+typedef enum {
+	VSYNC_OFF,
+	VSYNC_ON,
+	VSYNC_ADAPTIVE
+} VsyncMode;
+
+typedef struct {
+	uint frames;
+	uint missed;
+	float worst; // ms
+	float average; // ms
+} TimerStats;
+
+// Reads fps and vsync from the loop table of the config
+void tsab_timer_configure(LitState* state, LitInstance* config);
+// Needs the GL context to exist
+void tsab_timer_set_vsync(VsyncMode mode);
+void tsab_timer_set_fps(float fps);
+
+void tsab_timer_start();
+// Waits until the next frame is due, returns the time since the previous one in seconds
+float tsab_timer_wait();
+
+float tsab_timer_get_delta();
+float tsab_timer_get_fps();
+double tsab_timer_get_time();
+TimerStats* tsab_timer_get_stats();
+
+void tsab_timer_bind_api(LitState* state);
+
+#endif
\ No newline at end of file
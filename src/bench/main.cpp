@@ -0,0 +1,376 @@
+#include <tsab/tsab.hpp>
+#include <tsab/tsab_timer.hpp>
+#include <tsab/tsab_profiler.hpp>
+
+#include <SDL.h>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+/*
+ * Every allocation in the process gets counted, so that the frame loop can report how many it did
+ */
+
+static std::atomic<uint64_t> allocations;
+static std::atomic<uint64_t> allocated_bytes;
+
+static inline void count_allocation(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+#ifdef __GLIBC__
+extern "C" {
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* pointer, size_t size);
+
+	// Catches lit, SDL and libstdc++ (operator new ends up in malloc)
+	void* malloc(size_t size) {
+		count_allocation(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t count, size_t size) {
+		count_allocation(count * size);
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* pointer, size_t size) {
+		count_allocation(size);
+		return __libc_realloc(pointer, size);
+	}
+}
+#else
+void* operator new(size_t size) {
+	count_allocation(size);
+	void* pointer = malloc(size);
+
+	if (pointer == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+	free(pointer);
+}
+#endif
+
+typedef struct {
+	int frames;
+	int warmup;
+	bool headless;
+
+	const char* directory;
+	const char* output;
+	std::vector<std::string> filter;
+} BenchOptions;
+
+static void print_usage() {
+	fprintf(stderr,
+		"Usage: tsab_bench [options] [scene...]\n"
+		"  --frames N          measured frames per scene (default 1000)\n"
+		"  --warmup N          frames to run before measuring (default 60)\n"
+		"  --headless          run without a window, draw calls are only counted\n"
+		"  --video-driver NAME SDL video driver, e.g. offscreen (use LIBGL_ALWAYS_SOFTWARE=1 for a software GL)\n"
+		"  --scenes DIR        directory with the scenes (default bench)\n"
+		"  --out FILE          write the json report into FILE instead of stdout\n");
+}
+
+static float percentile(const std::vector<float>& sorted, float p) {
+	if (sorted.empty()) {
+		return 0;
+	}
+
+	size_t index = (size_t) (p * (sorted.size() - 1) + 0.5f);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void append_escaped(std::string* out, const char* string) {
+	out->push_back('"');
+
+	for (const char* c = string; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			out->push_back('\\');
+		}
+
+		out->push_back(*c);
+	}
+
+	out->push_back('"');
+}
+
+static void append_number(std::string* out, const char* name, double value, bool comma = true) {
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "\"%s\": %.4f%s", name, value, comma ? ", " : "");
+
+	out->append(buffer);
+}
+
+/*
+ * Runs inside of the forked child, returns the scene report as a json object
+ */
+static std::string run_scene(const std::string& name, BenchOptions* options) {
+	std::string json = "{\"name\": ";
+	append_escaped(&json, name.c_str());
+
+	if (!tsab_init(false, options->headless)) {
+		json += ", \"error\": \"failed to init\"}";
+		return json;
+	}
+
+	// Measure the engine, not the display
+	tsab_timer_set_vsync(VSYNC_OFF);
+	tsab_timer_set_fps(0);
+	tsab_setup_loop();
+
+	bool quit = false;
+
+	for (int i = 0; i < options->warmup && !quit; i++) {
+		quit = tsab_frame();
+	}
+
+	if (tsab_had_error()) {
+		tsab_quit();
+
+		json += ", \"error\": \"script error\"}";
+		return json;
+	}
+
+	std::vector<float> times;
+	std::vector<float> frame_allocations;
+
+	times.reserve(options->frames);
+	frame_allocations.reserve(options->frames);
+
+	double to_ms = 1000.0 / SDL_GetPerformanceFrequency();
+	uint64_t start_bytes = allocated_bytes.load();
+
+	for (int i = 0; i < options->frames && !quit; i++) {
+		uint64_t start_allocations = allocations.load();
+		Uint64 start = SDL_GetPerformanceCounter();
+
+		quit = tsab_frame();
+
+		times.push_back((SDL_GetPerformanceCounter() - start) * to_ms);
+		frame_allocations.push_back(allocations.load() - start_allocations);
+	}
+
+	uint64_t bytes = allocated_bytes.load() - start_bytes;
+	int frames = times.size();
+
+	if (tsab_had_error()) {
+		tsab_quit();
+
+		json += ", \"error\": \"script error\"}";
+		return json;
+	}
+
+	double total_time = 0;
+	double total_allocations = 0;
+
+	for (int i = 0; i < frames; i++) {
+		total_time += times[i];
+		total_allocations += frame_allocations[i];
+	}
+
+	std::sort(times.begin(), times.end());
+	std::sort(frame_allocations.begin(), frame_allocations.end());
+
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), ", \"frames\": %i, ", frames);
+
+	json += buffer;
+	json += "\"frame_ms\": {";
+
+	append_number(&json, "mean", frames > 0 ? total_time / frames : 0);
+	append_number(&json, "p50", percentile(times, 0.5f));
+	append_number(&json, "p90", percentile(times, 0.9f));
+	append_number(&json, "p99", percentile(times, 0.99f));
+	append_number(&json, "max", frames > 0 ? times.back() : 0, false);
+
+	json += "}, \"allocations\": {";
+
+	append_number(&json, "total", total_allocations);
+	append_number(&json, "per_frame", frames > 0 ? total_allocations / frames : 0);
+	append_number(&json, "p99_per_frame", percentile(frame_allocations, 0.99f));
+	append_number(&json, "max_per_frame", frames > 0 ? frame_allocations.back() : 0);
+	append_number(&json, "bytes_per_frame", frames > 0 ? (double) bytes / frames : 0, false);
+
+	// The profiler only keeps the last PROFILER_FRAMES frames around
+	json += "}, \"phases_ms\": {";
+	int entries = tsab_profiler_get_entry_count();
+
+	for (int i = 0; i < entries; i++) {
+		append_number(&json, tsab_profiler_get_entry_name(i), tsab_profiler_get_average(i, frames), i < entries - 1);
+	}
+
+	json += "}}";
+
+	tsab_quit();
+	return json;
+}
+
+/*
+ * Each scene gets its own process, so that the engine globals, the heap and the GPU state start out clean
+ */
+static std::string fork_scene(const std::filesystem::path& path, BenchOptions* options) {
+	std::string name = path.filename().string();
+	int fds[2];
+
+	if (pipe(fds) != 0) {
+		return "{\"name\": \"" + name + "\", \"error\": \"pipe failed\"}";
+	}
+
+	pid_t pid = fork();
+
+	if (pid == 0) {
+		close(fds[0]);
+
+		// Whatever the scene prints must not end up in the report
+		dup2(STDERR_FILENO, STDOUT_FILENO);
+
+		if (chdir(path.c_str()) != 0) {
+			_exit(1);
+		}
+
+		std::string json = run_scene(name, options);
+		const char* data = json.c_str();
+		size_t left = json.size();
+
+		while (left > 0) {
+			ssize_t written = write(fds[1], data, left);
+
+			if (written <= 0) {
+				_exit(1);
+			}
+
+			data += written;
+			left -= written;
+		}
+
+		close(fds[1]);
+		_exit(0);
+	}
+
+	close(fds[1]);
+
+	if (pid < 0) {
+		close(fds[0]);
+		return "{\"name\": \"" + name + "\", \"error\": \"fork failed\"}";
+	}
+
+	std::string json;
+	char buffer[4096];
+	ssize_t count;
+
+	while ((count = read(fds[0], buffer, sizeof(buffer))) > 0) {
+		json.append(buffer, count);
+	}
+
+	close(fds[0]);
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+		char error[128];
+		snprintf(error, sizeof(error), "{\"name\": \"%s\", \"error\": \"exited with status %i\"}", name.c_str(), status);
+
+		return error;
+	}
+
+	return json;
+}
+
+int main(int argc, const char** argv) {
+	BenchOptions options = { 1000, 60, false, "bench", nullptr };
+
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (strcmp(arg, "--frames") == 0 && has_value) {
+			options.frames = atoi(argv[++i]);
+		} else if (strcmp(arg, "--warmup") == 0 && has_value) {
+			options.warmup = atoi(argv[++i]);
+		} else if (strcmp(arg, "--headless") == 0) {
+			options.headless = true;
+		} else if (strcmp(arg, "--video-driver") == 0 && has_value) {
+			setenv("SDL_VIDEODRIVER", argv[++i], 1);
+		} else if (strcmp(arg, "--scenes") == 0 && has_value) {
+			options.directory = argv[++i];
+		} else if (strcmp(arg, "--out") == 0 && has_value) {
+			options.output = argv[++i];
+		} else if (arg[0] == '-') {
+			print_usage();
+			return 1;
+		} else {
+			options.filter.push_back(arg);
+		}
+	}
+
+	std::vector<std::filesystem::path> scenes;
+	std::error_code error;
+
+	for (auto & entry : std::filesystem::directory_iterator(options.directory, error)) {
+		std::string name = entry.path().filename().string();
+
+		if (!std::filesystem::exists(entry.path() / "main.lit")) {
+			continue;
+		}
+
+		if (options.filter.empty() || std::find(options.filter.begin(), options.filter.end(), name) != options.filter.end()) {
+			scenes.push_back(std::filesystem::absolute(entry.path()));
+		}
+	}
+
+	if (scenes.empty()) {
+		fprintf(stderr, "No scenes found in %s\n", options.directory);
+		return 1;
+	}
+
+	std::sort(scenes.begin(), scenes.end());
+
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "{\"frames\": %i, \"warmup\": %i, \"headless\": %s, \"scenes\": [\n", options.frames, options.warmup, options.headless ? "true" : "false");
+
+	std::string report = buffer;
+	bool failed = false;
+
+	for (size_t i = 0; i < scenes.size(); i++) {
+		fprintf(stderr, "Running %s\n", scenes[i].filename().c_str());
+		std::string json = fork_scene(scenes[i], &options);
+
+		failed |= json.find("\"error\"") != std::string::npos;
+		report += "\t" + json + (i < scenes.size() - 1 ? ",\n" : "\n");
+	}
+
+	report += "]}\n";
+
+	if (options.output == nullptr) {
+		fputs(report.c_str(), stdout);
+	} else {
+		FILE* file = fopen(options.output, "w");
+
+		if (file == nullptr) {
+			fprintf(stderr, "Failed to open %s\n", options.output);
+			return 1;
+		}
+
+		fputs(report.c_str(), file);
+		fclose(file);
+	}
+
+	return failed ? 1 : 0;
+}
\ No newline at end of file
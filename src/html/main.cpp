@@ -11,7 +11,7 @@ void loop_fn(void* arg) {
 }
 
 int main() {
-	if (!tsab_init(false)) {
+	if (!tsab_init(false, false)) {
 		printf("F.\n");
 		return -1;
 	}
@@ -1,7 +1,13 @@
 #include <tsab/tsab.hpp>
+#include <tsab/tsab_timer.hpp>
+
+#include <cstdlib>
 
 int main(int argc, const char** argv) {
 	bool debug = false;
+	bool headless = false;
+	int ticks = 0;
+	float fps = -1;
 
 	if (argc > 1) {
 		for (int i = 1; i < argc; i++) {
@@ -9,6 +15,12 @@ int main(int argc, const char** argv) {
 
 			if (strcmp(arg, "-d") == 0 || strcmp(arg, "--debug") == 0) {
 				debug = true;
+			} else if (strcmp(arg, "--headless") == 0) {
+				headless = true;
+			} else if (strcmp(arg, "--ticks") == 0 && i + 1 < argc) {
+				ticks = atoi(argv[++i]);
+			} else if (strcmp(arg, "--fps") == 0 && i + 1 < argc) {
+				fps = atof(argv[++i]);
 			} else {
 				printf("Unknown argument %s\n", arg);
 				return 1;
@@ -16,12 +28,29 @@ int main(int argc, const char** argv) {
 		}
 	}
 
-	if (!tsab_init(debug)) {
+	if (!tsab_init(debug, headless)) {
 		return -1;
 	}
 
+	if (fps >= 0) {
+		tsab_timer_set_fps(fps);
+	}
+
 	tsab_setup_loop();
-	tsab_loop();
+
+	if (ticks > 0) {
+		int tick = 0;
+
+		while (tick < ticks && !tsab_frame()) {
+			tick++;
+		}
+
+		double time = tsab_timer_get_time();
+		printf("Ran %i ticks in %.3f s (%.0f ticks/s)\n", tick, time, time > 0 ? tick / time : 0);
+	} else {
+		tsab_loop();
+	}
+
 	tsab_quit();
 
 	return 0;
@@ -1,6 +1,8 @@
 #include <tsab/graphics/tsab_animation.hpp>
 #include <tsab/graphics/tsab_graphics.hpp>
 #include <tsab/graphics/tsab_texture_region.hpp>
+#include <tsab/graphics/tsab_atlas.hpp>
+#include <tsab/graphics/tsab_loader.hpp>
 
 #define CUTE_ASEPRITE_IMPLEMENTATION
 #include "cute_aseprite.h"
@@ -12,6 +14,7 @@
 
 typedef struct {
 	int x;
+	int y;
 	float duration;
 } AnimationFrame;
 
@@ -66,20 +69,36 @@ void cleanup_animation_data(LitState* state, LitUserdata* d, bool mark) {
 	delete data->slices;
 }
 
-LIT_METHOD(animation_data_constructor) {
-	const char* path = LIT_CHECK_STRING(0);
+struct AsepriteSheet {
+	ase_t* ase;
+	std::vector<Uint8> pixels;
+
+	int columns;
+	int width;
+	int height;
+};
+
+AsepriteSheet* tsab_animation_decode(const char* path) {
 	ase_t* ase = cute_aseprite_load_from_file(path, nullptr);
 
 	if (ase == nullptr) {
-		lit_runtime_error(vm, "Failed to open aseprite file %s", path);
+		return nullptr;
 	}
 
-	int w = ase->frame_count * ase->w;
-	int h = ase->layer_count * ase->h;
-	auto size = w * h * 4;
+	AsepriteSheet* sheet = new AsepriteSheet();
+	sheet->ase = ase;
+
+	// Frames are laid out in rows, so that long animations still fit into an atlas page
+	int columns = fmax(1, fmin(ase->frame_count, ATLAS_MAX_SIZE / ase->w));
+	int rows = (ase->frame_count + columns - 1) / columns;
+
+	int w = columns * ase->w;
+	int h = rows * ase->h;
 
-	Uint8 pixels[size];
-	memset(pixels, 0, size);
+	sheet->columns = columns;
+	sheet->width = w;
+	sheet->height = h;
+	sheet->pixels.resize(w * h * 4, 0);
 
 	for (int f = 0; f < ase->frame_count; f++) {
 		auto frame = ase->frames[f];
@@ -88,36 +107,50 @@ LIT_METHOD(animation_data_constructor) {
 			continue;
 		}
 
-		auto cell = frame.cels[0];
+		auto pixel_data = (Uint8*) frame.pixels;
+		int frame_x = f % columns * ase->w;
+		int frame_y = f / columns * ase->h;
+
+		for (int y = 0; y < ase->h; y++) {
+			memcpy(&sheet->pixels[((frame_y + y) * w + frame_x) * 4], &pixel_data[y * ase->w * 4], ase->w * 4);
+		}
+	}
+
+	return sheet;
+}
 
-		int cw = fmin(cell.w, ase->w);
-		int ch = fmin(cell.h, ase->h);
+void tsab_animation_free_sheet(AsepriteSheet* sheet) {
+	cute_aseprite_free(sheet->ase);
+	delete sheet;
+}
 
-		auto pixelData = (Uint8*) frame.pixels;
+/*
+ * Uploads the decoded sheet and sets the instance up as AnimationData, the sheet is freed either way
+ */
+static bool fill_animation_data(LitVm* vm, LitValue instance, AsepriteSheet* sheet) {
+	ase_t* ase = sheet->ase;
+	int w = sheet->width;
+	int columns = sheet->columns;
 
-    for (int celY = 0; celY < ch; celY++) {
-			for (int celX = 0; celX < cw; celX++) {
-				auto index = (celX + celY * ase->w) * 4;
-				auto to = (celX + f * cw + (celY) * w) * 4;
+	SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(sheet->pixels.data(), w, sheet->height, 32, 4 * w, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+	AtlasRegion region;
 
-				for (int j = 0; j < 4; j++) {
-					pixels[to + j] = pixelData[index + j];
-				}
-			}
+	if (surface == nullptr || !tsab_atlas_add(surface, &region)) {
+		if (surface != nullptr) {
+			SDL_FreeSurface(surface);
 		}
-	}
 
-	SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(pixels, w, h, 32, 4 * w, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+		tsab_animation_free_sheet(sheet);
+		return false;
+	}
 
-	GPU_Image* texture = GPU_CopyImageFromSurface(surface);
-	GPU_SetImageFilter(texture, GPU_FILTER_NEAREST);
-	GPU_SetSnapMode(texture, GPU_SNAP_NONE);
+	SDL_FreeSurface(surface);
 
 	AnimationData* data = LIT_INSERT_DATA(AnimationData, cleanup_animation_data);
 
 	data->instance = instance;
-	data->texture_id = tsab_graphics_add_image(texture);
-	data->texture = texture;
+	data->texture_id = region.texture_id;
+	data->texture = region.texture;
 	data->tags = new std::map<char*, AnimationTag, char_cmp>();
 	data->slices = new std::map<char*, TextureRegion, char_cmp>();
 	data->width = ase->w;
@@ -141,7 +174,8 @@ LIT_METHOD(animation_data_constructor) {
 
 	for (int i = 0; i < data->frame_count; i++) {
 		data->frames[i] = (AnimationFrame) {
-			i * ase->w,
+			region.x + i % columns * ase->w,
+			region.y + i / columns * ase->h,
 			ase->frames[i].duration_milliseconds / 1000.0f
 		};
 	}
@@ -155,17 +189,63 @@ LIT_METHOD(animation_data_constructor) {
 
 		(*data->slices)[str] = (TextureRegion) {
 			data->texture,
-			(uint16_t) slice.origin_x,
-			(uint16_t) slice.origin_y,
+			(uint16_t) (region.x + slice.origin_x),
+			(uint16_t) (region.y + slice.origin_y),
 			(uint16_t) slice.w,
 			(uint16_t) slice.h
 		};
 	}
 
-	cute_aseprite_free(ase);
+	tsab_animation_free_sheet(sheet);
+	return true;
+}
+
+LitValue tsab_animation_data_new(LitVm* vm, AsepriteSheet* sheet) {
+	LitState* state = vm->state;
+	LitValue klass = lit_get_global(state, CONST_STRING(state, "AnimationData"));
+
+	if (!IS_CLASS(klass)) {
+		tsab_animation_free_sheet(sheet);
+		return NULL_VALUE;
+	}
+
+	LitInstance* data = lit_create_instance(state, AS_CLASS(klass));
+	LitValue instance = OBJECT_VALUE(data);
+
+	// Filling it in allocates, and nothing else references the instance yet
+	lit_push_root(state, (LitObject*) data);
+	bool filled = fill_animation_data(vm, instance, sheet);
+	lit_pop_root(state);
+
+	return filled ? instance : NULL_VALUE;
+}
+
+LIT_METHOD(animation_data_constructor) {
+	const char* path = LIT_CHECK_STRING(0);
+	AsepriteSheet* sheet = tsab_animation_decode(path);
+
+	if (sheet == nullptr) {
+		lit_runtime_error_exiting(vm, "Failed to open aseprite file %s", path);
+	}
+
+	if (!fill_animation_data(vm, instance, sheet)) {
+		lit_runtime_error_exiting(vm, "Failed to upload aseprite file %s", path);
+	}
+
 	return instance;
 }
 
+LIT_METHOD(animation_data_load_async) {
+	const char* path = LIT_CHECK_STRING(0);
+
+	if (arg_count < 2 || !IS_CALLABLE_FUNCTION(args[1])) {
+		lit_runtime_error_exiting(vm, "Expected function as argument #2");
+	}
+
+	tsab_loader_load_aseprite(vm, path, args[1]);
+	return NULL_VALUE;
+}
+
 LIT_METHOD(animation_data_get_slice) {
 	const char* name = LIT_CHECK_STRING(0);
 	auto data = LIT_EXTRACT_DATA(AnimationData);
@@ -328,7 +408,7 @@ LIT_METHOD(animation_frame) {
 		LitValue ar[5] = {
 			NUMBER_VALUE(animation->data->texture_id),
 			NUMBER_VALUE(animation->frame->x),
-			NUMBER_VALUE(0),
+			NUMBER_VALUE(animation->frame->y),
 			NUMBER_VALUE(animation->data->width),
 			NUMBER_VALUE(animation->data->height)
 		};
@@ -339,6 +419,7 @@ LIT_METHOD(animation_frame) {
 
 	auto animation_data = LIT_EXTRACT_DATA_FROM(animation->region, TextureRegion);
 	animation_data->x = animation->frame->x;
+	animation_data->y = animation->frame->y;
 
 	return animation->region;
 }
@@ -364,6 +445,7 @@ void tsab_animation_bind_api(LitState* state) {
 	LIT_BEGIN_CLASS("AnimationData")
 		LIT_BIND_CONSTRUCTOR(animation_data_constructor)
 
+		LIT_BIND_STATIC_METHOD("loadAsync", animation_data_load_async)
 		LIT_BIND_METHOD("getSlice", animation_data_get_slice)
 	LIT_END_CLASS()
 
@@ -0,0 +1,233 @@
+#include <tsab/graphics/tsab_atlas.hpp>
+#include <tsab/graphics/tsab_graphics.hpp>
+
+#include <SDL_image.h>
+
+#include <math.h>
+#include <vector>
+#include <iostream>
+
+#define ATLAS_PADDING 1
+
+typedef struct {
+	int x;
+	int y;
+	int w;
+} SkylineNode;
+
+typedef struct {
+	GPU_Image* texture;
+	int texture_id;
+
+	std::vector<SkylineNode> skyline;
+} AtlasPage;
+
+static std::vector<AtlasPage> pages;
+
+static AtlasPage* add_page() {
+	GPU_Image* texture = GPU_CreateImage(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, GPU_FORMAT_RGBA);
+
+	if (texture == nullptr) {
+		return nullptr;
+	}
+
+	GPU_SetImageFilter(texture, GPU_FILTER_NEAREST);
+	GPU_SetSnapMode(texture, GPU_SNAP_NONE);
+
+	// Fresh textures have undefined contents
+	std::vector<unsigned char> empty(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+	GPU_Rect rect = GPU_MakeRect(0, 0, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+	GPU_UpdateImageBytes(texture, &rect, empty.data(), ATLAS_PAGE_SIZE * 4);
+
+	pages.push_back((AtlasPage) { texture, tsab_graphics_add_image(texture) });
+	pages.back().skyline.push_back((SkylineNode) { 0, 0, ATLAS_PAGE_SIZE });
+
+	return &pages.back();
+}
+
+/*
+ * Returns the y, at which a w * h rect would rest on the skyline, starting at the given node, or -1 if it doesn't fit
+ */
+static int fit(AtlasPage* page, uint index, int w, int h) {
+	auto& skyline = page->skyline;
+
+	if (skyline[index].x + w > ATLAS_PAGE_SIZE) {
+		return -1;
+	}
+
+	int y = 0;
+	int left = w;
+
+	while (left > 0) {
+		if (index >= skyline.size()) {
+			return -1;
+		}
+
+		y = fmax(y, skyline[index].y);
+
+		if (y + h > ATLAS_PAGE_SIZE) {
+			return -1;
+		}
+
+		left -= skyline[index].w;
+		index++;
+	}
+
+	return y;
+}
+
+static void place(AtlasPage* page, uint index, int x, int y, int w, int h) {
+	auto& skyline = page->skyline;
+	skyline.insert(skyline.begin() + index, (SkylineNode) { x, y + h, w });
+
+	// Cut off the nodes, that are now under the new one
+	for (uint i = index + 1; i < skyline.size(); i++) {
+		auto node = &skyline[i];
+		int right = x + w;
+
+		if (node->x >= right) {
+			break;
+		}
+
+		int shrink = right - node->x;
+
+		if (node->w <= shrink) {
+			skyline.erase(skyline.begin() + i);
+			i--;
+		} else {
+			node->x += shrink;
+			node->w -= shrink;
+			break;
+		}
+	}
+
+	for (uint i = 0; i + 1 < skyline.size(); i++) {
+		if (skyline[i].y == skyline[i + 1].y) {
+			skyline[i].w += skyline[i + 1].w;
+			skyline.erase(skyline.begin() + i + 1);
+			i--;
+		}
+	}
+}
+
+static bool pack_into(AtlasPage* page, int w, int h, int* x, int* y) {
+	int best_index = -1;
+	int best_bottom = ATLAS_PAGE_SIZE + 1;
+	int best_width = ATLAS_PAGE_SIZE + 1;
+
+	// Bottom-left: the lowest spot wins, ties go to the narrowest node
+	for (uint i = 0; i < page->skyline.size(); i++) {
+		int node_y = fit(page, i, w, h);
+
+		if (node_y == -1) {
+			continue;
+		}
+
+		int bottom = node_y + h;
+
+		if (bottom < best_bottom || (bottom == best_bottom && page->skyline[i].w < best_width)) {
+			best_index = i;
+			best_bottom = bottom;
+			best_width = page->skyline[i].w;
+		}
+	}
+
+	if (best_index == -1) {
+		return false;
+	}
+
+	*x = page->skyline[best_index].x;
+	*y = best_bottom - h;
+
+	place(page, best_index, *x, *y, w, h);
+	return true;
+}
+
+bool tsab_atlas_pack(SDL_Surface* surface, AtlasRegion* region) {
+	if (surface->w > ATLAS_MAX_SIZE || surface->h > ATLAS_MAX_SIZE) {
+		return false;
+	}
+
+	int w = surface->w + ATLAS_PADDING;
+	int h = surface->h + ATLAS_PADDING;
+	int x;
+	int y;
+
+	AtlasPage* page = nullptr;
+
+	for (auto & existing : pages) {
+		if (pack_into(&existing, w, h, &x, &y)) {
+			page = &existing;
+			break;
+		}
+	}
+
+	if (page == nullptr) {
+		page = add_page();
+
+		if (page == nullptr || !pack_into(page, w, h, &x, &y)) {
+			return false;
+		}
+	}
+
+	GPU_Rect rect = GPU_MakeRect(x, y, surface->w, surface->h);
+	GPU_UpdateImage(page->texture, &rect, surface, nullptr);
+
+	region->texture = page->texture;
+	region->texture_id = page->texture_id;
+	region->x = x;
+	region->y = y;
+	region->w = surface->w;
+	region->h = surface->h;
+
+	return true;
+}
+
+bool tsab_atlas_add(SDL_Surface* surface, AtlasRegion* region) {
+	if (tsab_graphics_is_headless()) {
+		region->texture = nullptr;
+		region->texture_id = -1;
+		region->x = 0;
+		region->y = 0;
+		region->w = surface->w;
+		region->h = surface->h;
+
+		return true;
+	}
+
+	if (tsab_atlas_pack(surface, region)) {
+		return true;
+	}
+
+	GPU_Image* texture = GPU_CopyImageFromSurface(surface);
+
+	if (texture == nullptr) {
+		return false;
+	}
+
+	GPU_SetImageFilter(texture, GPU_FILTER_NEAREST);
+	GPU_SetSnapMode(texture, GPU_SNAP_NONE);
+
+	region->texture = texture;
+	region->texture_id = tsab_graphics_add_image(texture);
+	region->x = 0;
+	region->y = 0;
+	region->w = surface->w;
+	region->h = surface->h;
+
+	return true;
+}
+
+bool tsab_atlas_load(const char* path, AtlasRegion* region) {
+	SDL_Surface* surface = IMG_Load(path);
+
+	if (surface == nullptr) {
+		std::cerr << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	bool result = tsab_atlas_add(surface, region);
+
+	SDL_FreeSurface(surface);
+	return result;
+}
\ No newline at end of file
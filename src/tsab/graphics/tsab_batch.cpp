@@ -0,0 +1,134 @@
+#include <tsab/graphics/tsab_batch.hpp>
+#include <tsab/tsab_shaders.hpp>
+
+#include <math.h>
+
+static unsigned short* indices = nullptr;
+
+static void setup_indices() {
+	indices = new unsigned short[BATCH_MAX_QUADS * 6];
+
+	for (int i = 0; i < BATCH_MAX_QUADS; i++) {
+		unsigned short v = i * 4;
+		unsigned short* quad = indices + i * 6;
+
+		quad[0] = v;
+		quad[1] = v + 1;
+		quad[2] = v + 2;
+		quad[3] = v;
+		quad[4] = v + 2;
+		quad[5] = v + 3;
+	}
+}
+
+void tsab_batch_begin(QuadBatch* batch, GPU_Image* texture) {
+	batch->texture = texture;
+	batch->count = 0;
+}
+
+void tsab_batch_add(QuadBatch* batch, const GPU_Rect* src, float x, float y, float ox, float oy, float a, float sx, float sy, SDL_Color color) {
+	// Headless batches have no texture to map onto, they only keep count
+	if (batch->texture == nullptr) {
+		batch->count++;
+		return;
+	}
+
+	size_t offset = batch->count * 4 * BATCH_VERTEX_SIZE;
+
+	if (batch->vertices.size() < offset + 4 * BATCH_VERTEX_SIZE) {
+		batch->vertices.resize(offset + 4 * BATCH_VERTEX_SIZE);
+	}
+
+	batch->count++;
+
+	// Same transform as GPU_BlitTransformX: the origin lands on x, y, and we rotate (degrees) and scale around it
+	float x1 = -ox * sx;
+	float y1 = -oy * sy;
+	float x2 = (src->w - ox) * sx;
+	float y2 = (src->h - oy) * sy;
+
+	float corners[8] = {
+		x1, y1,
+		x2, y1,
+		x2, y2,
+		x1, y2
+	};
+
+	if (a != 0) {
+		float angle = a * M_PI / 180.0f;
+		float c = cosf(angle);
+		float s = sinf(angle);
+
+		for (int i = 0; i < 8; i += 2) {
+			float cx = corners[i];
+			float cy = corners[i + 1];
+
+			corners[i] = cx * c - cy * s;
+			corners[i + 1] = cx * s + cy * c;
+		}
+	}
+
+	float tw = batch->texture->texture_w;
+	float th = batch->texture->texture_h;
+
+	float s1 = src->x / tw;
+	float t1 = src->y / th;
+	float s2 = (src->x + src->w) / tw;
+	float t2 = (src->y + src->h) / th;
+
+	float tex[8] = {
+		s1, t1,
+		s2, t1,
+		s2, t2,
+		s1, t2
+	};
+
+	float r = color.r / 255.0f;
+	float g = color.g / 255.0f;
+	float b = color.b / 255.0f;
+	float al = color.a / 255.0f;
+
+	float* vertex = batch->vertices.data() + offset;
+
+	for (int i = 0; i < 4; i++) {
+		vertex[0] = x + corners[i * 2];
+		vertex[1] = y + corners[i * 2 + 1];
+		vertex[2] = tex[i * 2];
+		vertex[3] = tex[i * 2 + 1];
+		vertex[4] = r;
+		vertex[5] = g;
+		vertex[6] = b;
+		vertex[7] = al;
+
+		vertex += BATCH_VERTEX_SIZE;
+	}
+}
+
+void tsab_batch_draw(QuadBatch* batch, GPU_Target* target) {
+	if (batch->count == 0 || batch->texture == nullptr) {
+		return;
+	}
+
+	if (indices == nullptr) {
+		setup_indices();
+	}
+
+	tsab_shaders_set_textured(true);
+
+	float* vertices = batch->vertices.data();
+	uint left = batch->count;
+
+	while (left > 0) {
+		uint count = left > BATCH_MAX_QUADS ? BATCH_MAX_QUADS : left;
+
+		GPU_TriangleBatch(batch->texture, target, count * 4, vertices, count * 6, indices, GPU_BATCH_XY_ST_RGBA);
+
+		vertices += count * 4 * BATCH_VERTEX_SIZE;
+		left -= count;
+	}
+}
+
+void tsab_batch_flush(QuadBatch* batch, GPU_Target* target) {
+	tsab_batch_draw(batch, target);
+	batch->count = 0;
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <tsab/graphics/tsab_color.hpp>
+#include <tsab/tsab.hpp>
+
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+	LitString* string;
+	uint length;
+	char chars[COLOR_MAX_LENGTH];
+	SDL_Color color;
+} ColorCacheEntry;
+
+static ColorCacheEntry cache[COLOR_CACHE_SIZE];
+
+// Kept alive with tsab_keep_alive()
+static LitString* channel_names[4];
+
+double tsab_color_pack(SDL_Color color) {
+	uint32_t rgba = ((uint32_t) color.r << 24) | ((uint32_t) color.g << 16) | ((uint32_t) color.b << 8) | color.a;
+	return COLOR_TAG + rgba;
+}
+
+SDL_Color tsab_color_unpack(double packed) {
+	uint32_t rgba = (uint32_t) (packed - COLOR_TAG);
+	return { (Uint8) (rgba >> 24), (Uint8) (rgba >> 16), (Uint8) (rgba >> 8), (Uint8) rgba };
+}
+
+bool tsab_color_is_packed(LitValue value) {
+	if (!IS_NUMBER(value)) {
+		return false;
+	}
+
+	double number = AS_NUMBER(value);
+	return number >= COLOR_TAG && number < COLOR_TAG * 2;
+}
+
+static int hex_digit(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	} else if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+bool tsab_color_parse_hex(const char* string, uint length, SDL_Color* out) {
+	if (length > 0 && string[0] == '#') {
+		string++;
+		length--;
+	}
+
+	if (length != 3 && length != 6 && length != 8) {
+		return false;
+	}
+
+	int digits[8];
+
+	for (uint i = 0; i < length; i++) {
+		if ((digits[i] = hex_digit(string[i])) == -1) {
+			return false;
+		}
+	}
+
+	if (length == 3) {
+		// #f80 is #ff8800
+		*out = { (Uint8) (digits[0] * 17), (Uint8) (digits[1] * 17), (Uint8) (digits[2] * 17), 255 };
+		return true;
+	}
+
+	*out = {
+		(Uint8) (digits[0] * 16 + digits[1]),
+		(Uint8) (digits[2] * 16 + digits[3]),
+		(Uint8) (digits[4] * 16 + digits[5]),
+		(Uint8) (length == 8 ? digits[6] * 16 + digits[7] : 255)
+	};
+
+	return true;
+}
+
+/*
+ * Lit interns its strings, so the same color literal is always the same object. The chars are compared too,
+ * because the collector might have freed the string and reused its memory for a different one
+ */
+bool tsab_color_from_string(LitString* string, SDL_Color* out) {
+	if (string->length > COLOR_MAX_LENGTH) {
+		return false;
+	}
+
+	ColorCacheEntry* entry = &cache[string->hash % COLOR_CACHE_SIZE];
+
+	if (entry->string == string && entry->length == string->length && memcmp(entry->chars, string->chars, string->length) == 0) {
+		*out = entry->color;
+		return true;
+	}
+
+	if (!tsab_color_parse_hex(string->chars, string->length, out)) {
+		return false;
+	}
+
+	entry->string = string;
+	entry->length = string->length;
+	entry->color = *out;
+
+	memcpy(entry->chars, string->chars, string->length);
+	return true;
+}
+
+static Uint8 to_byte(double value) {
+	return (Uint8) fmax(0, fmin(255, value));
+}
+
+bool tsab_color_read(LitVm* vm, uint arg_count, LitValue* args, SDL_Color* out) {
+	if (arg_count == 0) {
+		return false;
+	}
+
+	LitValue first = args[0];
+
+	if (IS_STRING(first)) {
+		return tsab_color_from_string(AS_STRING(first), out);
+	} else if (tsab_color_is_packed(first)) {
+		*out = tsab_color_unpack(AS_NUMBER(first));
+		return true;
+	} else if (IS_ARRAY(first)) {
+		LitValues* values = &AS_ARRAY(first)->values;
+
+		if (values->count < 3) {
+			lit_runtime_error_exiting(vm, "Expected at least 3 values in the color array");
+		}
+
+		Uint8 channels[4] = { 255, 255, 255, 255 };
+
+		for (uint i = 0; i < fmin(4, values->count); i++) {
+			if (IS_NUMBER(values->values[i])) {
+				channels[i] = to_byte(AS_NUMBER(values->values[i]));
+			}
+		}
+
+		*out = { channels[0], channels[1], channels[2], channels[3] };
+		return true;
+	}
+
+	if (arg_count < 3) {
+		Uint8 value = to_byte(LIT_CHECK_NUMBER(0));
+		*out = { value, value, value, to_byte(LIT_GET_NUMBER(1, 255)) };
+	} else {
+		*out = {
+			to_byte(LIT_CHECK_NUMBER(0)),
+			to_byte(LIT_CHECK_NUMBER(1)),
+			to_byte(LIT_CHECK_NUMBER(2)),
+			to_byte(LIT_GET_NUMBER(3, 255))
+		};
+	}
+
+	return true;
+}
+
+/*
+ * API
+ */
+
+LIT_METHOD(color_rgb) {
+	SDL_Color color;
+
+	if (!tsab_color_read(vm, arg_count, args, &color)) {
+		return NULL_VALUE;
+	}
+
+	return NUMBER_VALUE(tsab_color_pack(color));
+}
+
+LIT_METHOD(color_hex) {
+	SDL_Color color;
+
+	if (arg_count < 1 || !IS_STRING(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected string as argument #1");
+	}
+
+	if (!tsab_color_from_string(AS_STRING(args[0]), &color)) {
+		return NULL_VALUE;
+	}
+
+	return NUMBER_VALUE(tsab_color_pack(color));
+}
+
+LIT_METHOD(color_unpack) {
+	LitState* state = vm->state;
+	LitInstance* result;
+
+	if (arg_count < 1 || !tsab_color_is_packed(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected packed color as argument #1");
+	}
+
+	if (arg_count > 1 && IS_INSTANCE(args[1])) {
+		result = AS_INSTANCE(args[1]);
+	} else {
+		result = lit_create_instance(state, state->object_class);
+	}
+
+	SDL_Color color = tsab_color_unpack(AS_NUMBER(args[0]));
+	Uint8 channels[4] = { color.r, color.g, color.b, color.a };
+
+	lit_push_root(state, (LitObject*) result);
+
+	for (int i = 0; i < 4; i++) {
+		lit_table_set(state, &result->fields, channel_names[i], NUMBER_VALUE(channels[i]));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+void tsab_color_bind_api(LitState* state) {
+	const char* names[4] = { "r", "g", "b", "a" };
+
+	for (int i = 0; i < 4; i++) {
+		channel_names[i] = CONST_STRING(state, names[i]);
+		tsab_keep_alive((LitObject*) channel_names[i]);
+	}
+
+	LIT_BEGIN_CLASS("Color")
+		LIT_BIND_STATIC_METHOD("rgb", color_rgb)
+		LIT_BIND_STATIC_METHOD("hex", color_hex)
+		LIT_BIND_STATIC_METHOD("unpack", color_unpack)
+	LIT_END_CLASS()
+}
\ No newline at end of file
@@ -0,0 +1,378 @@
+#include <tsab/graphics/tsab_font.hpp>
+#include <tsab/graphics/tsab_batch.hpp>
+#include <tsab/graphics/tsab_graphics.hpp>
+
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+#define PAGE_SIZE 512
+#define GLYPH_PADDING 1
+
+typedef struct {
+	int page;
+	GPU_Rect rect;
+	float advance;
+} Glyph;
+
+typedef struct {
+	GPU_Image* texture;
+
+	// Shelf packer state
+	int x;
+	int y;
+	int shelf_height;
+} FontPage;
+
+struct FontAtlas {
+	TTF_Font* font;
+
+	int height;
+	int line_skip;
+
+	Glyph* ascii[128];
+	std::unordered_map<Uint16, Glyph*> glyphs;
+	std::vector<FontPage> pages;
+};
+
+typedef struct {
+	Glyph* glyph;
+	float x;
+	float y;
+} LaidGlyph;
+
+// Shared between all fonts, so that steady-state printing doesn't allocate
+static std::vector<LaidGlyph> laid_glyphs;
+static QuadBatch batch;
+
+FontAtlas* tsab_font_new(TTF_Font* font) {
+	FontAtlas* atlas = new FontAtlas();
+
+	atlas->font = font;
+	atlas->height = TTF_FontHeight(font);
+	atlas->line_skip = TTF_FontLineSkip(font);
+
+	memset(atlas->ascii, 0, sizeof(atlas->ascii));
+	return atlas;
+}
+
+void tsab_font_free(FontAtlas* atlas) {
+	for (auto & page : atlas->pages) {
+		GPU_FreeImage(page.texture);
+	}
+
+	for (int i = 0; i < 128; i++) {
+		delete atlas->ascii[i];
+	}
+
+	for (auto & [key, glyph] : atlas->glyphs) {
+		delete glyph;
+	}
+
+	TTF_CloseFont(atlas->font);
+	delete atlas;
+}
+
+static FontPage* add_page(FontAtlas* atlas) {
+	GPU_Image* texture = GPU_CreateImage(PAGE_SIZE, PAGE_SIZE, GPU_FORMAT_RGBA);
+
+	if (texture == nullptr) {
+		return nullptr;
+	}
+
+	GPU_SetImageFilter(texture, GPU_FILTER_NEAREST);
+
+	// Fresh textures have undefined contents
+	std::vector<unsigned char> empty(PAGE_SIZE * PAGE_SIZE * 4, 0);
+	GPU_Rect rect = GPU_MakeRect(0, 0, PAGE_SIZE, PAGE_SIZE);
+	GPU_UpdateImageBytes(texture, &rect, empty.data(), PAGE_SIZE * 4);
+
+	atlas->pages.push_back((FontPage) { texture, 0, 0, 0 });
+	return &atlas->pages.back();
+}
+
+static bool pack(FontAtlas* atlas, int w, int h, int* page, int* x, int* y) {
+	if (w + GLYPH_PADDING > PAGE_SIZE || h + GLYPH_PADDING > PAGE_SIZE) {
+		return false;
+	}
+
+	FontPage* current = atlas->pages.empty() ? add_page(atlas) : &atlas->pages.back();
+
+	if (current == nullptr) {
+		return false;
+	}
+
+	if (current->x + w + GLYPH_PADDING > PAGE_SIZE) {
+		current->x = 0;
+		current->y += current->shelf_height;
+		current->shelf_height = 0;
+	}
+
+	if (current->y + h + GLYPH_PADDING > PAGE_SIZE) {
+		if ((current = add_page(atlas)) == nullptr) {
+			return false;
+		}
+	}
+
+	*page = atlas->pages.size() - 1;
+	*x = current->x;
+	*y = current->y;
+
+	current->x += w + GLYPH_PADDING;
+	current->shelf_height = fmax(current->shelf_height, h + GLYPH_PADDING);
+
+	return true;
+}
+
+static Glyph* render_glyph(FontAtlas* atlas, Uint16 code) {
+	Glyph* glyph = new Glyph();
+
+	glyph->page = -1;
+	glyph->rect = GPU_MakeRect(0, 0, 0, 0);
+
+	int advance = 0;
+
+	if (TTF_GlyphMetrics(atlas->font, code, nullptr, nullptr, nullptr, nullptr, &advance) == 0) {
+		glyph->advance = advance;
+	} else {
+		glyph->advance = 0;
+	}
+
+	if (tsab_graphics_is_headless()) {
+		return glyph;
+	}
+
+	// Render through the string path, so that the glyph surface is baseline-aligned and font-height tall,
+	// the same way it used to be when we rendered whole strings
+	char str[4];
+
+	if (code < 0x80) {
+		str[0] = code;
+		str[1] = '\0';
+	} else if (code < 0x800) {
+		str[0] = 0xC0 | (code >> 6);
+		str[1] = 0x80 | (code & 0x3F);
+		str[2] = '\0';
+	} else {
+		str[0] = 0xE0 | (code >> 12);
+		str[1] = 0x80 | ((code >> 6) & 0x3F);
+		str[2] = 0x80 | (code & 0x3F);
+		str[3] = '\0';
+	}
+
+	SDL_Surface* surface = TTF_RenderUTF8_Blended(atlas->font, str, { 255, 255, 255, 255 });
+
+	if (surface == nullptr) {
+		return glyph;
+	}
+
+	int page, x, y;
+
+	if (pack(atlas, surface->w, surface->h, &page, &x, &y)) {
+		glyph->page = page;
+		glyph->rect = GPU_MakeRect(x, y, surface->w, surface->h);
+
+		GPU_UpdateImage(atlas->pages[page].texture, &glyph->rect, surface, nullptr);
+	} else {
+		std::cerr << "Failed to fit glyph " << code << " into the font atlas" << std::endl;
+	}
+
+	SDL_FreeSurface(surface);
+	return glyph;
+}
+
+static Glyph* get_glyph(FontAtlas* atlas, Uint16 code) {
+	if (code < 128) {
+		Glyph* glyph = atlas->ascii[code];
+
+		if (glyph == nullptr) {
+			glyph = atlas->ascii[code] = render_glyph(atlas, code);
+		}
+
+		return glyph;
+	}
+
+	auto iterator = atlas->glyphs.find(code);
+
+	if (iterator != atlas->glyphs.end()) {
+		return iterator->second;
+	}
+
+	Glyph* glyph = render_glyph(atlas, code);
+	atlas->glyphs[code] = glyph;
+
+	return glyph;
+}
+
+static Uint16 decode_utf8(const char** text) {
+	auto str = (const unsigned char*) *text;
+	Uint32 code = str[0];
+	int length = 1;
+
+	if (code >= 0xF0) {
+		length = 4;
+		code = '?'; // Outside of what SDL_ttf can render with 16 bit glyph ids
+	} else if (code >= 0xE0) {
+		length = 3;
+		code = ((code & 0x0F) << 12) | ((str[1] & 0x3F) << 6) | (str[2] & 0x3F);
+	} else if (code >= 0xC0) {
+		length = 2;
+		code = ((code & 0x1F) << 6) | (str[1] & 0x3F);
+	}
+
+	for (int i = 1; i < length; i++) {
+		if (str[i] == '\0') {
+			length = i;
+			code = '?';
+			break;
+		}
+	}
+
+	*text += length;
+	return (Uint16) code;
+}
+
+/*
+ * Lays the text out into laid_glyphs, wrapping at spaces once a line grows past wrap (if it's above 0)
+ */
+static void layout(FontAtlas* atlas, const char* text, float wrap, float* width, float* height) {
+	laid_glyphs.clear();
+
+	float pen_x = 0;
+	float pen_y = 0;
+	int break_index = -1;
+	Uint16 previous = 0;
+
+	while (*text != '\0') {
+		Uint16 code = decode_utf8(&text);
+
+		if (code == '\n') {
+			pen_x = 0;
+			pen_y += atlas->line_skip;
+			break_index = -1;
+			previous = 0;
+
+			continue;
+		}
+
+		Glyph* glyph = get_glyph(atlas, code);
+
+		if (previous != 0) {
+			pen_x += TTF_GetFontKerningSizeGlyphs(atlas->font, previous, code);
+		}
+
+		if (wrap > 0 && code != ' ' && break_index > -1 && pen_x + glyph->advance > wrap) {
+			// Move the current word onto the next line
+			float shift = break_index < (int) laid_glyphs.size() ? laid_glyphs[break_index].x : pen_x;
+
+			for (uint i = break_index; i < laid_glyphs.size(); i++) {
+				laid_glyphs[i].x -= shift;
+				laid_glyphs[i].y += atlas->line_skip;
+			}
+
+			pen_x -= shift;
+			pen_y += atlas->line_skip;
+			break_index = -1;
+		}
+
+		laid_glyphs.push_back((LaidGlyph) { glyph, pen_x, pen_y });
+		pen_x += glyph->advance;
+		previous = code;
+
+		if (code == ' ') {
+			break_index = laid_glyphs.size();
+		}
+	}
+
+	float w = 0;
+
+	for (auto & laid : laid_glyphs) {
+		w = fmax(w, laid.x + fmax(laid.glyph->advance, laid.glyph->rect.w));
+	}
+
+	*width = w;
+	*height = pen_y + atlas->height;
+}
+
+void tsab_font_measure(FontAtlas* atlas, const char* text, float wrap, float* width, float* height) {
+	layout(atlas, text, wrap, width, height);
+}
+
+static void draw_laid_glyphs(FontAtlas* atlas, GPU_Target* target, float x, float y, float w, float h, float r, float sx, float sy, SDL_Color color) {
+	// Rotate and scale around the center of the whole text block, like the old single-image path did
+	float cx = w / 2.0f;
+	float cy = h / 2.0f;
+	int page = -1;
+
+	for (auto & laid : laid_glyphs) {
+		Glyph* glyph = laid.glyph;
+
+		if (glyph->page < 0 || glyph->rect.w == 0) {
+			continue;
+		}
+
+		if (glyph->page != page) {
+			tsab_batch_flush(&batch, target);
+			tsab_batch_begin(&batch, atlas->pages[glyph->page].texture);
+
+			page = glyph->page;
+		}
+
+		tsab_batch_add(&batch, &glyph->rect, x + cx, y + cy, cx - laid.x, cy - laid.y, r, sx, sy, color);
+	}
+
+	tsab_batch_flush(&batch, target);
+}
+
+void tsab_font_print(FontAtlas* atlas, GPU_Target* target, const char* text, float x, float y, float wrap, float r, float sx, float sy, SDL_Color color) {
+	float w;
+	float h;
+
+	layout(atlas, text, wrap, &w, &h);
+
+	if (!laid_glyphs.empty()) {
+		draw_laid_glyphs(atlas, target, x, y, w, h, r, sx, sy, color);
+	}
+}
+
+GPU_Image* tsab_font_bake(FontAtlas* atlas, const char* text, float wrap) {
+	float w;
+	float h;
+
+	layout(atlas, text, wrap, &w, &h);
+
+	if (laid_glyphs.empty() || w < 1 || h < 1) {
+		return nullptr;
+	}
+
+	GPU_Image* image = GPU_CreateImage(ceilf(w), ceilf(h), GPU_FORMAT_RGBA);
+
+	if (image == nullptr) {
+		return nullptr;
+	}
+
+	GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
+	GPU_Target* target = GPU_LoadTarget(image);
+
+	if (target == nullptr) {
+		GPU_FreeImage(image);
+		return nullptr;
+	}
+
+	GPU_Clear(target);
+
+	// The glyphs are white, so blending them as premultiplied keeps the baked texture straight-alpha white,
+	// instead of darkening the edges against the transparent black background
+	for (auto & page : atlas->pages) {
+		GPU_SetBlendMode(page.texture, GPU_BLEND_PREMULTIPLIED_ALPHA);
+	}
+
+	draw_laid_glyphs(atlas, target, 0, 0, w, h, 0, 1, 1, { 255, 255, 255, 255 });
+
+	for (auto & page : atlas->pages) {
+		GPU_SetBlendMode(page.texture, GPU_BLEND_NORMAL);
+	}
+
+	GPU_FreeTarget(target);
+	return image;
+}
\ No newline at end of file
@@ -2,8 +2,15 @@
 #include <tsab/graphics/tsab_texture_region.hpp>
 #include <tsab/graphics/tsab_animation.hpp>
 #include <tsab/graphics/tsab_tilemap.hpp>
+#include <tsab/graphics/tsab_font.hpp>
+#include <tsab/graphics/tsab_text.hpp>
+#include <tsab/graphics/tsab_sprite_batch.hpp>
+#include <tsab/graphics/tsab_atlas.hpp>
+#include <tsab/graphics/tsab_loader.hpp>
+#include <tsab/graphics/tsab_color.hpp>
 #include <tsab/tsab_shaders.hpp>
 #include <tsab/tsab_common.hpp>
+#include <tsab/tsab.hpp>
 
 #include "SDL_gpu.h"
 #include <SDL.h>
@@ -11,8 +18,6 @@
 #include <SDL_image.h>
 
 #include <vector>
-#include <string>
-#include <regex>
 #include <iostream>
 
 #define CURRENT_TARGET current_target == nullptr ? screen : current_target->target
@@ -21,19 +26,28 @@ static SDL_Color current_color = { 255, 255, 255, 255 };
 static float bg_color[] = { 0, 0, 0, 1 };
 
 static SDL_Window* window;
-static SDL_Renderer* renderer;
 
 static GPU_Target *screen;
 static GPU_Image *current_target;
 
 static std::vector<GPU_Image *> image_list;
-static std::vector<TTF_Font *> fonts;
-static TTF_Font *active_font;
+static std::vector<FontAtlas *> fonts;
+static FontAtlas *active_font;
 static bool pushed = false;
+static float camera_x = 0;
+static float camera_y = 0;
+static float camera_scale = 1;
 static bool window_hidden = true;
 static float total_time = 0;
 
-bool tsab_graphics_init(LitState* state, LitInstance* config) {
+// Without a window and a GPU, draw calls only get counted
+static bool headless = false;
+static int headless_width;
+static int headless_height;
+static uint frame_draw_calls = 0;
+static uint total_draw_calls = 0;
+
+bool tsab_graphics_init(LitState* state, LitInstance* config, bool no_window) {
 	int width = 640;
 	int height = 480;
 	int min_width = -1;
@@ -85,13 +99,15 @@ bool tsab_graphics_init(LitState* state, LitInstance* config) {
 		}
 	}
 
-	window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_RESIZABLE);
+	if (no_window) {
+		headless = true;
+		headless_width = width;
+		headless_height = height;
 
-	if (window == nullptr) {
-		return false;
+		return true;
 	}
 
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_RESIZABLE);
 
 	if (window == nullptr) {
 		return false;
@@ -124,7 +140,7 @@ bool tsab_graphics_init(LitState* state, LitInstance* config) {
 }
 
 void tsab_graphics_handle_event(SDL_Event* event) {
-	if (event->type == SDL_WINDOWEVENT && event->window.event == SDL_WINDOWEVENT_RESIZED) {
+	if (!headless && event->type == SDL_WINDOWEVENT && event->window.event == SDL_WINDOWEVENT_RESIZED) {
 		int w;
 		int h;
 
@@ -142,6 +158,10 @@ void tsab_graphics_set_title(const char* title) {
 }
 
 void tsab_graphics_get_ready() {
+	if (headless) {
+		return;
+	}
+
 	SDL_ShowWindow(window);
 	window_hidden = false;
 }
@@ -151,10 +171,14 @@ void tsab_graphics_quit() {
 		GPU_FreeImage(image_list[i]);
 	}
 
-	GPU_Quit();
+	tsab_text_quit();
 
-	if (renderer != nullptr) {
-		SDL_DestroyRenderer(renderer);
+	for (int i = 0; i < fonts.size(); i++) {
+		tsab_font_free(fonts[i]);
+	}
+
+	if (!headless) {
+		GPU_Quit();
 	}
 
 	if (window != nullptr) {
@@ -164,11 +188,19 @@ void tsab_graphics_quit() {
 
 void tsab_graphics_begin_frame(float dt) {
 	total_time += dt;
+	frame_draw_calls = 0;
+
+	if (headless) {
+		return;
+	}
+
 	GPU_ClearRGBA(screen, bg_color[0], bg_color[1], bg_color[2], bg_color[3]);
 }
 
 void tsab_graphics_finish_frame() {
-	GPU_Flip(screen);
+	if (!headless) {
+		GPU_Flip(screen);
+	}
 }
 
 void tsab_graphics_clear_screen() {
@@ -188,6 +220,28 @@ int tsab_graphics_add_image(GPU_Image* image) {
 	return image_list.size() - 1;
 }
 
+SDL_Color tsab_graphics_get_color() {
+	return current_color;
+}
+
+GPU_Rect tsab_graphics_get_visible_rect() {
+	if (headless) {
+		return GPU_MakeRect(-camera_x, -camera_y, headless_width / camera_scale, headless_height / camera_scale);
+	}
+
+	GPU_Target* target = CURRENT_TARGET;
+	return GPU_MakeRect(-camera_x, -camera_y, target->w / camera_scale, target->h / camera_scale);
+}
+
+bool tsab_graphics_is_headless() {
+	return headless;
+}
+
+void tsab_graphics_count_draw() {
+	frame_draw_calls++;
+	total_draw_calls++;
+}
+
 /*
  * API
  */
@@ -197,33 +251,18 @@ LIT_METHOD(tsab_graphics_flip) {
 	return NULL_VALUE;
 }
 
-LIT_METHOD(tsab_graphics_clear) {
-	if (arg_count == 3) {
-		for (int i = 0; i < 3; i++) {
-			bg_color[i] = (float) LIT_CHECK_NUMBER(i);
-		}
-
-		bg_color[3] = 255;
-	} else if (arg_count == 1) {
-		float value = (float) LIT_CHECK_NUMBER(0);
-
-		for (int i = 0; i < 3; i++) {
-			bg_color[i] = value;
-		}
-
-		bg_color[3] = 255;
-	} else if (arg_count == 2) {
-		float value = (float) LIT_CHECK_NUMBER(0);
+static void set_clear_color(SDL_Color color) {
+	bg_color[0] = color.r;
+	bg_color[1] = color.g;
+	bg_color[2] = color.b;
+	bg_color[3] = color.a;
+}
 
-		for (int i = 0; i < 3; i++) {
-			bg_color[i] = value;
-		}
+LIT_METHOD(tsab_graphics_clear) {
+	SDL_Color color;
 
-		bg_color[3] = (float) LIT_CHECK_NUMBER(1);
-	} else if (arg_count == 4) {
-		for (int i = 0; i < 4; i++) {
-			bg_color[i] = (float) LIT_CHECK_NUMBER(i);
-		}
+	if (tsab_color_read(vm, arg_count, args, &color)) {
+		set_clear_color(color);
 	}
 
 	GPU_ClearRGBA(CURRENT_TARGET, bg_color[0], bg_color[1], bg_color[2], bg_color[3]);
@@ -234,6 +273,11 @@ LIT_METHOD(tsab_graphics_new_canvas) {
 	double w = LIT_CHECK_NUMBER(0);
 	double h = LIT_CHECK_NUMBER(1);
 
+	if (headless) {
+		image_list.push_back(nullptr);
+		return NUMBER_VALUE(image_list.size() - 1);
+	}
+
 	GPU_Image *image = GPU_CreateImage(w, h, GPU_FORMAT_RGBA);
 	GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
 	GPU_LoadTarget(image);
@@ -257,6 +301,12 @@ LIT_METHOD(tsab_graphics_set_canvas) {
 
 LIT_METHOD(tsab_graphics_new_image) {
 	const char *name = LIT_CHECK_STRING(0);
+
+	if (headless) {
+		image_list.push_back(nullptr);
+		return NUMBER_VALUE(image_list.size() - 1);
+	}
+
 	SDL_Surface *texture = IMG_Load(name);
 
 	if (texture == nullptr) {
@@ -271,133 +321,51 @@ LIT_METHOD(tsab_graphics_new_image) {
 	return NUMBER_VALUE(image_list.size() - 1);
 }
 
-LIT_METHOD(tsab_graphics_set_clear_color) {
-	if (arg_count > 0 && IS_STRING(args[0])) {
-		std::string color = std::string(AS_CSTRING(args[0]));
-
-		if (color.size() != 7) {
-			return NULL_VALUE;
-		}
-
-		std::regex pattern("#?([0-9a-fA-F]{2})([0-9a-fA-F]{2})([0-9a-fA-F]{2})");
-		std::smatch match;
-
-		if (std::regex_match(color, match, pattern)) {
-			bg_color[0] = std::stoul(match[1].str(), nullptr, 16);
-			bg_color[1] = std::stoul(match[2].str(), nullptr, 16);
-			bg_color[2] = std::stoul(match[3].str(), nullptr, 16);
-			bg_color[3] = 255;
-		}
-	} else {
-		if (arg_count == 3) {
-			for (int i = 0; i < 3; i++) {
-				bg_color[i] = (float) LIT_CHECK_NUMBER(i);
-			}
+LIT_METHOD(tsab_graphics_load_image_async) {
+	const char *name = LIT_CHECK_STRING(0);
 
-			bg_color[3] = 255;
-		} else if (arg_count == 1) {
-			if (IS_ARRAY(args[0])) {
-				LitArray* array = AS_ARRAY(args[0]);
+	if (arg_count < 2 || !IS_CALLABLE_FUNCTION(args[1])) {
+		lit_runtime_error_exiting(vm, "Expected function as argument #2");
+	}
 
-				if (array->values.count < 3) {
-					lit_runtime_error_exiting(vm, "Expected at least 3 values in the color array");
-				}
+	tsab_loader_load_image(vm, name, args[1]);
+	return NULL_VALUE;
+}
 
-				for (int i = 0; i < fmin(4, array->values.count); i++) {
-					LitValue value = array->values.values[i];
+/*
+ * Loads an image into the shared atlas, so that it can be drawn in one batch with other regions
+ */
+LIT_METHOD(tsab_graphics_new_region) {
+	const char *name = LIT_CHECK_STRING(0);
+	AtlasRegion region;
 
-					if (IS_NUMBER(value)) {
-						bg_color[i] = AS_NUMBER(value);
-					}
-				}
-			} else {
-				float value = (float) LIT_CHECK_NUMBER(0);
+	if (!tsab_atlas_load(name, &region)) {
+		return NULL_VALUE;
+	}
 
-				for (int i = 0; i < 3; i++) {
-					bg_color[i] = value;
-				}
+	LitValue ar[5] = {
+		NUMBER_VALUE(region.texture_id),
+		NUMBER_VALUE(region.x),
+		NUMBER_VALUE(region.y),
+		NUMBER_VALUE(region.w),
+		NUMBER_VALUE(region.h)
+	};
 
-				bg_color[3] = 255;
-			}
-		} else if (arg_count == 2) {
-			float value = (float) LIT_CHECK_NUMBER(0);
+	return lit_call_new(vm, "TextureRegion", ar, 5);
+}
 
-			for (int i = 0; i < 3; i++) {
-				bg_color[i] = value;
-			}
+LIT_METHOD(tsab_graphics_set_clear_color) {
+	SDL_Color color;
 
-			bg_color[3] = (float) LIT_CHECK_NUMBER(1);
-		} else if (arg_count >= 4) {
-			for (int i = 0; i < 4; i++) {
-				bg_color[i] = (float) LIT_CHECK_NUMBER(i);
-			}
-		}
+	if (tsab_color_read(vm, arg_count, args, &color)) {
+		set_clear_color(color);
 	}
 
 	return NULL_VALUE;
 }
 
 LIT_METHOD(tsab_graphics_set_color) {
-	if (arg_count > 0 && IS_STRING(args[0])) {
-		std::string color = std::string(AS_CSTRING(args[0]));
-
-		if (color.size() != 7) {
-			return NULL_VALUE;
-		}
-
-		std::regex pattern("#?([0-9a-fA-F]{2})([0-9a-fA-F]{2})([0-9a-fA-F]{2})");
-		std::smatch match;
-
-		if (std::regex_match(color, match, pattern)) {
-			current_color.r = std::stoul(match[1].str(), nullptr, 16);
-			current_color.g = std::stoul(match[2].str(), nullptr, 16);
-			current_color.b = std::stoul(match[3].str(), nullptr, 16);
-			current_color.a = 255;
-		}
-	} else {
-		if (arg_count == 3) {
-			current_color.r = (Uint8) LIT_CHECK_NUMBER(0);
-			current_color.g = (Uint8) LIT_CHECK_NUMBER(1);
-			current_color.b = (Uint8) LIT_CHECK_NUMBER(2);
-			current_color.a = 255;
-		} else if (arg_count == 1) {
-			if (IS_ARRAY(args[0])) {
-				LitArray* array = AS_ARRAY(args[0]);
-
-				if (array->values.count < 3) {
-					lit_runtime_error_exiting(vm, "Expected at least 3 values in the color array");
-				}
-
-				for (int i = 0; i < fmin(4, array->values.count); i++) {
-					LitValue value = array->values.values[i];
-
-					if (IS_NUMBER(value)) {
-						bg_color[i] = AS_NUMBER(value);
-					}
-				}
-			} else {
-				Uint8 value = (Uint8) LIT_CHECK_NUMBER(0);
-
-				current_color.r = value;
-				current_color.g = value;
-				current_color.b = value;
-				current_color.a = 255;
-			}
-		} else if (arg_count == 2) {
-			Uint8 value = (Uint8) LIT_CHECK_NUMBER(0);
-
-			current_color.r = value;
-			current_color.g = value;
-			current_color.b = value;
-			current_color.a = (Uint8) LIT_CHECK_NUMBER(1);
-		} else if (arg_count >= 4) {
-			current_color.r = (Uint8) LIT_CHECK_NUMBER(0);
-			current_color.g = (Uint8) LIT_CHECK_NUMBER(1);
-			current_color.b = (Uint8) LIT_CHECK_NUMBER(2);
-			current_color.a = (Uint8) LIT_CHECK_NUMBER(3);
-		}
-	}
-
+	tsab_color_read(vm, arg_count, args, &current_color);
 	return NULL_VALUE;
 }
 
@@ -441,8 +409,16 @@ LIT_METHOD(tsab_graphics_draw) {
 		src_h = region->h;
 	}
 
+	SDL_Color color = current_color;
+	// Regions bring their own source rect, so the color comes right after the scale
+	uint color_index = region == nullptr ? 12 : 8;
+
+	if (arg_count > color_index) {
+		tsab_color_read(vm, 1, args + color_index, &color);
+	}
+
 	GPU_Rect r = GPU_MakeRect(src_x, src_y, src_w, src_h);
-	GPU_SetRGBA(what, current_color.r, current_color.g, current_color.b, current_color.a);
+	GPU_SetRGBA(what, color.r, color.g, color.b, color.a);
 	GPU_BlitTransformX(what, &r, target, x, y, ox, oy, a, sx, sy);
 
 	return NULL_VALUE;
@@ -557,11 +533,13 @@ LIT_METHOD(tsab_graphics_new_font) {
 		return NULL_VALUE;
 	}
 
+	FontAtlas *atlas = tsab_font_new(font);
+
 	if (active_font == nullptr) {
-		active_font = font;
+		active_font = atlas;
 	}
 
-	fonts.push_back(font);
+	fonts.push_back(atlas);
 	return NUMBER_VALUE(fonts.size() - 1);
 }
 
@@ -583,19 +561,28 @@ static void load_font() {
 
 	if (font == nullptr) {
 		std::cerr << "Failed to load default font: " << TTF_GetError() << std::endl;
+		return;
 	}
 
-	active_font = font;
-	fonts.push_back(font);
+	active_font = tsab_font_new(font);
+	fonts.push_back(active_font);
 }
 
-LIT_METHOD(tsab_graphics_print) {
-	tsab_shaders_set_textured(true);
-
+FontAtlas* tsab_graphics_get_font() {
 	if (active_font == nullptr) {
 		load_font();
 	}
 
+	return active_font;
+}
+
+LIT_METHOD(tsab_graphics_print) {
+	FontAtlas *font = tsab_graphics_get_font();
+
+	if (font == nullptr) {
+		return NULL_VALUE;
+	}
+
 	const char *text = LIT_CHECK_STRING(0);
 	double x = LIT_GET_NUMBER(1, 0);
 	double y = LIT_GET_NUMBER(2, 0);
@@ -603,21 +590,18 @@ LIT_METHOD(tsab_graphics_print) {
 	double sx = LIT_GET_NUMBER(4, 1);
 	double sy = LIT_GET_NUMBER(5, 1);
 
-	SDL_Surface *surface = TTF_RenderUTF8_Blended(active_font, text, current_color);
-	GPU_Image *image = GPU_CopyImageFromSurface(surface);
-
-	GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
-	GPU_BlitTransformX(image, nullptr, CURRENT_TARGET, x + image->w / 2.0f, y + image->h / 2.0f,image->w / 2.0f, image->h / 2.0f, r, sx, sy);
+	if (!tsab_text_cache_draw(font, CURRENT_TARGET, text, x, y, 0, r, sx, sy, current_color)) {
+		tsab_font_print(font, CURRENT_TARGET, text, x, y, 0, r, sx, sy, current_color);
+	}
 
-	SDL_FreeSurface(surface);
 	return NULL_VALUE;
 }
 
 LIT_METHOD(tsab_graphics_printf) {
-	tsab_shaders_set_textured(true);
+	FontAtlas *font = tsab_graphics_get_font();
 
-	if (active_font == nullptr) {
-		load_font();
+	if (font == nullptr) {
+		return NULL_VALUE;
 	}
 
 	const char *text = LIT_CHECK_STRING(0);
@@ -628,13 +612,21 @@ LIT_METHOD(tsab_graphics_printf) {
 	double sx = LIT_GET_NUMBER(5, 1);
 	double sy = LIT_GET_NUMBER(6, 1);
 
-	SDL_Surface *surface = TTF_RenderText_Blended_Wrapped(active_font, text, current_color, length);
-	GPU_Image *image = GPU_CopyImageFromSurface(surface);
+	if (!tsab_text_cache_draw(font, CURRENT_TARGET, text, x, y, length, r, sx, sy, current_color)) {
+		tsab_font_print(font, CURRENT_TARGET, text, x, y, length, r, sx, sy, current_color);
+	}
 
-	GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
-	GPU_BlitTransformX(image, nullptr, CURRENT_TARGET, x + image->w / 2.0f, y + image->h / 2.0f,image->w / 2.0f, image->h / 2.0f, r, sx, sy);
+	return NULL_VALUE;
+}
+
+LIT_METHOD(tsab_graphics_new_text) {
+	return lit_call_new(vm, "Text", args, arg_count);
+}
+
+LIT_METHOD(tsab_graphics_set_text_cache_budget) {
+	double bytes = LIT_CHECK_NUMBER(0);
+	tsab_text_cache_set_budget(bytes < 0 ? 0 : (size_t) bytes);
 
-	SDL_FreeSurface(surface);
 	return NULL_VALUE;
 }
 
@@ -643,22 +635,35 @@ LIT_METHOD(tsab_graphics_set_camera) {
 	double y = LIT_GET_NUMBER(1, 0);
 	double s = LIT_GET_NUMBER(2, 1);
 
-	GPU_MatrixMode(CURRENT_TARGET, GPU_MODEL);
-
 	if (pushed) {
+		GPU_MatrixMode(CURRENT_TARGET, GPU_MODEL);
 		GPU_PopMatrix();
 	}
 
-	if (arg_count == 0) {
+	if (arg_count == 0 || s == 0) {
 		pushed = false;
+
+		camera_x = 0;
+		camera_y = 0;
+		camera_scale = 1;
+
 		return NULL_VALUE;
 	}
 
+	camera_x = x;
+	camera_y = y;
+	camera_scale = s;
+
 	if (current_target == nullptr) {
 		y *= -1;
 	}
 
+	if (headless) {
+		return NULL_VALUE;
+	}
+
 	pushed = true;
+	GPU_MatrixMode(CURRENT_TARGET, GPU_MODEL);
 	GPU_PushMatrix();
 	GPU_Scale(s, s, 1.0f);
 	GPU_Translate(x, y, 0.0f);
@@ -666,6 +671,46 @@ LIT_METHOD(tsab_graphics_set_camera) {
 	return NULL_VALUE;
 }
 
+// Fields of the visible rect object, kept alive with tsab_keep_alive()
+static LitString* rect_fields[4];
+
+/*
+ * Returns the part of the world, that the camera currently sees, as an object with x, y, width and height
+ * (pass an existing object to have it filled instead of allocating a new one every frame)
+ */
+LIT_METHOD(tsab_graphics_get_visible_rect) {
+	LitState* state = vm->state;
+	LitInstance* rect;
+
+	if (arg_count > 0 && IS_INSTANCE(args[0])) {
+		rect = AS_INSTANCE(args[0]);
+	} else {
+		rect = lit_create_instance(state, state->object_class);
+	}
+
+	GPU_Rect visible = tsab_graphics_get_visible_rect();
+	float values[4] = { visible.x, visible.y, visible.w, visible.h };
+
+	lit_push_root(state, (LitObject*) rect);
+
+	for (int i = 0; i < 4; i++) {
+		lit_table_set(state, &rect->fields, rect_fields[i], NUMBER_VALUE(values[i]));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(rect);
+}
+
+LIT_METHOD(tsab_graphics_is_visible) {
+	double x = LIT_CHECK_NUMBER(0);
+	double y = LIT_CHECK_NUMBER(1);
+	double w = LIT_GET_NUMBER(2, 0);
+	double h = LIT_GET_NUMBER(3, 0);
+
+	GPU_Rect visible = tsab_graphics_get_visible_rect();
+	return BOOL_VALUE(x + w >= visible.x && y + h >= visible.y && x <= visible.x + visible.w && y <= visible.y + visible.h);
+}
+
 LIT_METHOD(tsab_graphics_set_clip) {
 	if (arg_count == 0) {
 		GPU_UnsetClip(CURRENT_TARGET);
@@ -698,7 +743,7 @@ LIT_METHOD(tsab_graphics_set_shader) {
 }
 
 LIT_METHOD(tsab_window_title_get) {
-	return OBJECT_VALUE(OBJECT_CONST_STRING(vm->state, SDL_GetWindowTitle(window)));
+	return OBJECT_VALUE(OBJECT_CONST_STRING(vm->state, window == nullptr ? "" : SDL_GetWindowTitle(window)));
 }
 
 LIT_METHOD(tsab_window_title_set) {
@@ -761,6 +806,10 @@ LIT_METHOD(tsab_window_time_get) {
 }
 
 LIT_METHOD(tsab_window_width_get) {
+	if (headless) {
+		return NUMBER_VALUE(headless_width);
+	}
+
 	int x;
 	int y;
 
@@ -769,6 +818,10 @@ LIT_METHOD(tsab_window_width_get) {
 }
 
 LIT_METHOD(tsab_window_height_get) {
+	if (headless) {
+		return NUMBER_VALUE(headless_height);
+	}
+
 	int x;
 	int y;
 
@@ -796,16 +849,16 @@ LIT_METHOD(tsab_window_set_fullscreen) {
 }
 
 LIT_METHOD(tsab_window_x_get) {
-	int x;
-	int y;
+	int x = 0;
+	int y = 0;
 
 	SDL_GetWindowPosition(window, &x, &y);
 	return NUMBER_VALUE(x);
 }
 
 LIT_METHOD(tsab_window_y_get) {
-	int x;
-	int y;
+	int x = 0;
+	int y = 0;
 
 	SDL_GetWindowPosition(window, &x, &y);
 	return NUMBER_VALUE(y);
@@ -820,56 +873,93 @@ LIT_METHOD(tsab_window_set_position) {
 	return NULL_VALUE;
 }
 
+LIT_METHOD(tsab_graphics_get_draw_calls) {
+	return NUMBER_VALUE(LIT_GET_BOOL(0, false) ? total_draw_calls : frame_draw_calls);
+}
+
+LIT_METHOD(tsab_graphics_headless_draw) {
+	tsab_graphics_count_draw();
+	return NULL_VALUE;
+}
+
+LIT_METHOD(tsab_graphics_headless_noop) {
+	return NULL_VALUE;
+}
+
 void tsab_graphics_bind_api(LitState* state) {
+	// Headless runs swap everything, that needs a window or the GPU, for stubs
+	#define NOOP_METHOD(method) (headless ? tsab_graphics_headless_noop : method)
+	#define DRAW_METHOD(method) (headless ? tsab_graphics_headless_draw : method)
+
+	const char* fields[4] = { "x", "y", "width", "height" };
+
+	for (int i = 0; i < 4; i++) {
+		rect_fields[i] = CONST_STRING(state, fields[i]);
+		tsab_keep_alive((LitObject*) rect_fields[i]);
+	}
+
 	LIT_BEGIN_CLASS("Window")
-		LIT_BIND_STATIC_FIELD("title", tsab_window_title_get, tsab_window_title_set)
-		LIT_BIND_STATIC_FIELD("hidden", tsab_window_hidden_get, tsab_window_hidden_set)
-		LIT_BIND_STATIC_FIELD("showCursor", tsab_window_cursor_get, tsab_window_cursor_set)
-		LIT_BIND_STATIC_METHOD("minimize", tsab_window_minimize)
-		LIT_BIND_STATIC_METHOD("maximize", tsab_window_maximize)
-		LIT_BIND_STATIC_METHOD("restore", tsab_window_restore)
-		LIT_BIND_STATIC_METHOD("raise", tsab_window_raise)
+		LIT_BIND_STATIC_FIELD("title", tsab_window_title_get, NOOP_METHOD(tsab_window_title_set))
+		LIT_BIND_STATIC_FIELD("hidden", tsab_window_hidden_get, NOOP_METHOD(tsab_window_hidden_set))
+		LIT_BIND_STATIC_FIELD("showCursor", tsab_window_cursor_get, NOOP_METHOD(tsab_window_cursor_set))
+		LIT_BIND_STATIC_METHOD("minimize", NOOP_METHOD(tsab_window_minimize))
+		LIT_BIND_STATIC_METHOD("maximize", NOOP_METHOD(tsab_window_maximize))
+		LIT_BIND_STATIC_METHOD("restore", NOOP_METHOD(tsab_window_restore))
+		LIT_BIND_STATIC_METHOD("raise", NOOP_METHOD(tsab_window_raise))
 
 		LIT_BIND_STATIC_GETTER("time", tsab_window_time_get)
 		LIT_BIND_STATIC_GETTER("width", tsab_window_width_get)
 		LIT_BIND_STATIC_GETTER("height", tsab_window_height_get)
-		LIT_BIND_STATIC_METHOD("setSize", tsab_window_set_size)
-		LIT_BIND_STATIC_METHOD("setFullscreen", tsab_window_set_fullscreen)
+		LIT_BIND_STATIC_METHOD("setSize", NOOP_METHOD(tsab_window_set_size))
+		LIT_BIND_STATIC_METHOD("setFullscreen", NOOP_METHOD(tsab_window_set_fullscreen))
 
 		LIT_BIND_STATIC_GETTER("x", tsab_window_x_get)
 		LIT_BIND_STATIC_GETTER("y", tsab_window_y_get)
-		LIT_BIND_STATIC_METHOD("setPosition", tsab_window_set_position)
+		LIT_BIND_STATIC_METHOD("setPosition", NOOP_METHOD(tsab_window_set_position))
 	LIT_END_CLASS()
 
 	LIT_BEGIN_CLASS("Graphics")
-		LIT_BIND_STATIC_METHOD("flip", tsab_graphics_flip)
-		LIT_BIND_STATIC_METHOD("clear", tsab_graphics_clear)
+		LIT_BIND_STATIC_METHOD("flip", NOOP_METHOD(tsab_graphics_flip))
+		LIT_BIND_STATIC_METHOD("clear", NOOP_METHOD(tsab_graphics_clear))
 		LIT_BIND_STATIC_METHOD("setColor", tsab_graphics_set_color)
 		LIT_BIND_STATIC_METHOD("setClearColor", tsab_graphics_set_clear_color)
 		LIT_BIND_STATIC_METHOD("newCanvas", tsab_graphics_new_canvas)
-		LIT_BIND_STATIC_METHOD("setCanvas", tsab_graphics_set_canvas)
+		LIT_BIND_STATIC_METHOD("setCanvas", NOOP_METHOD(tsab_graphics_set_canvas))
 		LIT_BIND_STATIC_METHOD("newImage", tsab_graphics_new_image)
+		LIT_BIND_STATIC_METHOD("newRegion", tsab_graphics_new_region)
+		LIT_BIND_STATIC_METHOD("loadImageAsync", tsab_graphics_load_image_async)
 
-		LIT_BIND_STATIC_METHOD("draw", tsab_graphics_draw)
-		LIT_BIND_STATIC_METHOD("circle", tsab_graphics_circle)
-		LIT_BIND_STATIC_METHOD("rectangle", tsab_graphics_rectangle)
-		LIT_BIND_STATIC_METHOD("ellipse", tsab_graphics_ellipse)
-		LIT_BIND_STATIC_METHOD("triangle", tsab_graphics_triangle)
-		LIT_BIND_STATIC_METHOD("point", tsab_graphics_point)
-		LIT_BIND_STATIC_METHOD("line", tsab_graphics_line)
+		LIT_BIND_STATIC_METHOD("draw", DRAW_METHOD(tsab_graphics_draw))
+		LIT_BIND_STATIC_METHOD("circle", DRAW_METHOD(tsab_graphics_circle))
+		LIT_BIND_STATIC_METHOD("rectangle", DRAW_METHOD(tsab_graphics_rectangle))
+		LIT_BIND_STATIC_METHOD("ellipse", DRAW_METHOD(tsab_graphics_ellipse))
+		LIT_BIND_STATIC_METHOD("triangle", DRAW_METHOD(tsab_graphics_triangle))
+		LIT_BIND_STATIC_METHOD("point", DRAW_METHOD(tsab_graphics_point))
+		LIT_BIND_STATIC_METHOD("line", DRAW_METHOD(tsab_graphics_line))
 
 		LIT_BIND_STATIC_METHOD("newFont", tsab_graphics_new_font)
 		LIT_BIND_STATIC_METHOD("setFont", tsab_graphics_set_font)
-		LIT_BIND_STATIC_METHOD("print", tsab_graphics_print)
-		LIT_BIND_STATIC_METHOD("printf", tsab_graphics_printf)
+		LIT_BIND_STATIC_METHOD("print", DRAW_METHOD(tsab_graphics_print))
+		LIT_BIND_STATIC_METHOD("printf", DRAW_METHOD(tsab_graphics_printf))
+		LIT_BIND_STATIC_METHOD("newText", tsab_graphics_new_text)
+		LIT_BIND_STATIC_METHOD("setTextCacheBudget", tsab_graphics_set_text_cache_budget)
 
 		LIT_BIND_STATIC_METHOD("setCamera", tsab_graphics_set_camera)
-		LIT_BIND_STATIC_METHOD("setClip", tsab_graphics_set_clip)
+		LIT_BIND_STATIC_METHOD("getVisibleRect", tsab_graphics_get_visible_rect)
+		LIT_BIND_STATIC_METHOD("isVisible", tsab_graphics_is_visible)
+		LIT_BIND_STATIC_METHOD("setClip", NOOP_METHOD(tsab_graphics_set_clip))
 
-		LIT_BIND_STATIC_METHOD("setShader", tsab_graphics_set_shader)
+		LIT_BIND_STATIC_METHOD("setShader", NOOP_METHOD(tsab_graphics_set_shader))
+		LIT_BIND_STATIC_METHOD("getDrawCalls", tsab_graphics_get_draw_calls)
 	LIT_END_CLASS()
 
+	#undef NOOP_METHOD
+	#undef DRAW_METHOD
+
+	tsab_color_bind_api(state);
 	tsab_texture_region_bind_api(state);
+	tsab_text_bind_api(state);
+	tsab_sprite_batch_bind_api(state);
 	tsab_animation_bind_api(state);
 	tsab_tilemap_bind_api(state);
 }
@@ -0,0 +1,290 @@
+#include <tsab/graphics/tsab_loader.hpp>
+#include <tsab/graphics/tsab_graphics.hpp>
+#include <tsab/graphics/tsab_animation.hpp>
+#include <tsab/tsab.hpp>
+
+#include <SDL.h>
+#include <SDL_image.h>
+#include "SDL_gpu.h"
+
+#include <math.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <iostream>
+
+#ifndef EMSCRIPTEN
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+// How long the uploads are allowed to take every frame (at least one image is uploaded no matter what)
+#define UPLOAD_BUDGET_MS 2.0
+#define MAX_WORKERS 4
+
+typedef enum {
+	LOAD_IMAGE,
+	LOAD_ASEPRITE
+} LoadType;
+
+typedef struct {
+	LoadType type;
+	std::string path;
+	// Index of the callback in tsab._loading
+	uint slot;
+
+	SDL_Surface* surface;
+	AsepriteSheet* sheet;
+} LoadJob;
+
+static std::deque<LoadJob*> pending;
+static std::deque<LoadJob*> decoded;
+
+#ifndef EMSCRIPTEN
+static std::vector<std::thread> workers;
+static std::mutex pending_mutex;
+static std::mutex decoded_mutex;
+static std::condition_variable pending_condition;
+static bool stopping = false;
+#endif
+
+static void decode(LoadJob* job) {
+	if (job->type == LOAD_IMAGE) {
+		job->surface = IMG_Load(job->path.c_str());
+	} else {
+		job->sheet = tsab_animation_decode(job->path.c_str());
+	}
+}
+
+static void free_job(LoadJob* job) {
+	if (job->surface != nullptr) {
+		SDL_FreeSurface(job->surface);
+	}
+
+	if (job->sheet != nullptr) {
+		tsab_animation_free_sheet(job->sheet);
+	}
+
+	delete job;
+}
+
+#ifndef EMSCRIPTEN
+static void worker_loop() {
+	while (true) {
+		LoadJob* job;
+
+		{
+			std::unique_lock<std::mutex> lock(pending_mutex);
+			pending_condition.wait(lock, [] { return stopping || !pending.empty(); });
+
+			if (stopping) {
+				return;
+			}
+
+			job = pending.front();
+			pending.pop_front();
+		}
+
+		decode(job);
+
+		std::lock_guard<std::mutex> lock(decoded_mutex);
+		decoded.push_back(job);
+	}
+}
+#endif
+
+/*
+ * The callbacks live in an array on the tsab instance, so that the gc doesn't collect them while the image is loading
+ */
+static LitArray* get_callbacks(LitState* state) {
+	LitInstance* tsab = tsab_get_instance();
+	LitValue value = lit_get_field(state, &tsab->fields, "_loading");
+
+	if (IS_ARRAY(value)) {
+		return AS_ARRAY(value);
+	}
+
+	LitArray* array = lit_create_array(state);
+	lit_push_root(state, (LitObject*) array);
+
+	LitString* name = CONST_STRING(state, "_loading");
+	lit_push_root(state, (LitObject*) name);
+
+	lit_table_set(state, &tsab->fields, name, OBJECT_VALUE(array));
+	lit_pop_roots(state, 2);
+
+	return array;
+}
+
+static void queue_job(LitVm* vm, LoadType type, const char* path, LitValue callback) {
+	LitState* state = vm->state;
+	LitValues* callbacks = &get_callbacks(state)->values;
+	uint slot = callbacks->count;
+
+	for (uint i = 0; i < callbacks->count; i++) {
+		if (IS_NULL(callbacks->values[i])) {
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot == callbacks->count) {
+		lit_values_write(state, callbacks, callback);
+	} else {
+		callbacks->values[slot] = callback;
+	}
+
+	LoadJob* job = new LoadJob();
+
+	job->type = type;
+	job->path = path;
+	job->slot = slot;
+	job->surface = nullptr;
+	job->sheet = nullptr;
+
+#ifdef EMSCRIPTEN
+	// No threads here, the decoding happens in tsab_loader_update, one job per frame
+	pending.push_back(job);
+#else
+	if (workers.empty()) {
+		int count = fmax(1, fmin(MAX_WORKERS, (int) std::thread::hardware_concurrency() - 1));
+
+		for (int i = 0; i < count; i++) {
+			workers.emplace_back(worker_loop);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		pending.push_back(job);
+	}
+
+	pending_condition.notify_one();
+#endif
+}
+
+static LitValue upload(LitVm* vm, LoadJob* job) {
+	if (job->type == LOAD_IMAGE) {
+		if (job->surface == nullptr) {
+			std::cerr << "Failed to load image " << job->path << std::endl;
+			return NULL_VALUE;
+		}
+
+		if (tsab_graphics_is_headless()) {
+			return NUMBER_VALUE(tsab_graphics_add_image(nullptr));
+		}
+
+		GPU_Image* image = GPU_CopyImageFromSurface(job->surface);
+
+		if (image == nullptr) {
+			return NULL_VALUE;
+		}
+
+		GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
+		return NUMBER_VALUE(tsab_graphics_add_image(image));
+	}
+
+	if (job->sheet == nullptr) {
+		std::cerr << "Failed to load aseprite file " << job->path << std::endl;
+		return NULL_VALUE;
+	}
+
+	AsepriteSheet* sheet = job->sheet;
+	job->sheet = nullptr;
+
+	return tsab_animation_data_new(vm, sheet);
+}
+
+static LoadJob* take_decoded() {
+#ifdef EMSCRIPTEN
+	if (pending.empty()) {
+		return nullptr;
+	}
+
+	LoadJob* job = pending.front();
+	pending.pop_front();
+	decode(job);
+
+	return job;
+#else
+	std::lock_guard<std::mutex> lock(decoded_mutex);
+
+	if (decoded.empty()) {
+		return nullptr;
+	}
+
+	LoadJob* job = decoded.front();
+	decoded.pop_front();
+
+	return job;
+#endif
+}
+
+void tsab_loader_update(LitState* state) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	double frequency = SDL_GetPerformanceFrequency();
+
+	while (true) {
+		LoadJob* job = take_decoded();
+
+		if (job == nullptr) {
+			return;
+		}
+
+		LitValues* callbacks = &get_callbacks(state)->values;
+		LitValue callback = callbacks->values[job->slot];
+		LitValue result = upload(state->vm, job);
+
+		callbacks->values[job->slot] = NULL_VALUE;
+		free_job(job);
+
+		if (!IS_NULL(callback)) {
+			tsab_handle_call(lit_call(state, callback, &result, 1));
+		}
+
+#ifdef EMSCRIPTEN
+		return;
+#else
+		if ((SDL_GetPerformanceCounter() - start) * 1000.0 / frequency >= UPLOAD_BUDGET_MS) {
+			return;
+		}
+#endif
+	}
+}
+
+void tsab_loader_quit() {
+#ifndef EMSCRIPTEN
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		stopping = true;
+	}
+
+	pending_condition.notify_all();
+
+	for (auto & worker : workers) {
+		worker.join();
+	}
+
+	workers.clear();
+#endif
+
+	for (auto job : pending) {
+		free_job(job);
+	}
+
+	for (auto job : decoded) {
+		free_job(job);
+	}
+
+	pending.clear();
+	decoded.clear();
+}
+
+void tsab_loader_load_image(LitVm* vm, const char* path, LitValue callback) {
+	queue_job(vm, LOAD_IMAGE, path, callback);
+}
+
+void tsab_loader_load_aseprite(LitVm* vm, const char* path, LitValue callback) {
+	queue_job(vm, LOAD_ASEPRITE, path, callback);
+}
\ No newline at end of file
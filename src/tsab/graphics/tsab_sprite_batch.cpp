@@ -0,0 +1,299 @@
+#include <tsab/graphics/tsab_sprite_batch.hpp>
+#include <tsab/graphics/tsab_graphics.hpp>
+#include <tsab/graphics/tsab_texture_region.hpp>
+#include <tsab/graphics/tsab_batch.hpp>
+#include <tsab/graphics/tsab_color.hpp>
+
+#include "SDL_gpu.h"
+
+#include <math.h>
+
+typedef struct {
+	QuadBatch* batch;
+
+	GPU_Rect region;
+	SDL_Color color;
+
+	float origin_x;
+	float origin_y;
+} SpriteBatch;
+
+void cleanup_sprite_batch(LitState* state, LitUserdata* data, bool mark) {
+	if (mark) {
+		return;
+	}
+
+	auto batch = (SpriteBatch*) data->data;
+
+	delete batch->batch;
+	batch->batch = nullptr;
+}
+
+static GPU_Image* extract_texture(LitVm* vm, LitValue value, GPU_Rect* region) {
+	GPU_Image* texture = nullptr;
+
+	if (IS_NUMBER(value)) {
+		texture = tsab_graphics_get_image(AS_NUMBER(value));
+
+		if (texture != nullptr) {
+			*region = GPU_MakeRect(0, 0, texture->w, texture->h);
+		}
+	} else if (IS_INSTANCE(value)) {
+		TextureRegion* texture_region = LIT_EXTRACT_DATA_FROM(value, TextureRegion);
+		texture = texture_region->texture;
+
+		*region = GPU_MakeRect(texture_region->x, texture_region->y, texture_region->w, texture_region->h);
+	}
+
+	return texture;
+}
+
+LIT_METHOD(sprite_batch_constructor) {
+	LIT_ENSURE_MIN_ARGS(1)
+
+	GPU_Rect region;
+	GPU_Image* texture = extract_texture(vm, args[0], &region);
+
+	if (texture == nullptr) {
+		if (!tsab_graphics_is_headless()) {
+			lit_runtime_error_exiting(vm, "Unknown texture");
+		}
+
+		region = GPU_MakeRect(0, 0, 0, 0);
+	}
+
+	SpriteBatch* batch = LIT_INSERT_DATA(SpriteBatch, cleanup_sprite_batch);
+
+	batch->batch = new QuadBatch();
+	batch->region = region;
+	batch->color = { 255, 255, 255, 255 };
+	batch->origin_x = 0;
+	batch->origin_y = 0;
+
+	tsab_batch_begin(batch->batch, texture);
+
+	int capacity = LIT_GET_NUMBER(1, 0);
+
+	if (capacity > 0) {
+		batch->batch->vertices.reserve(capacity * 4 * BATCH_VERTEX_SIZE);
+	}
+
+	return instance;
+}
+
+/*
+ * add(x, y, a, ox, oy, sx, sy, src_x, src_y, src_w, src_h, color)
+ * add(region, x, y, a, ox, oy, sx, sy, color)
+ */
+LIT_METHOD(sprite_batch_add) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+	GPU_Rect r = batch->region;
+	uint offset = 0;
+
+	if (arg_count > 0 && IS_INSTANCE(args[0])) {
+		TextureRegion* region = LIT_EXTRACT_DATA_FROM(args[0], TextureRegion);
+
+		if (region->texture != batch->batch->texture) {
+			lit_runtime_error_exiting(vm, "The region belongs to a different texture than the batch");
+		}
+
+		r = GPU_MakeRect(region->x, region->y, region->w, region->h);
+		offset = 1;
+	}
+
+	float x = LIT_GET_NUMBER(offset, 0);
+	float y = LIT_GET_NUMBER(offset + 1, 0);
+	float a = LIT_GET_NUMBER(offset + 2, 0);
+	float ox = LIT_GET_NUMBER(offset + 3, batch->origin_x);
+	float oy = LIT_GET_NUMBER(offset + 4, batch->origin_y);
+	float sx = LIT_GET_NUMBER(offset + 5, 1);
+	float sy = LIT_GET_NUMBER(offset + 6, 1);
+
+	if (offset == 0) {
+		r.x = LIT_GET_NUMBER(7, r.x);
+		r.y = LIT_GET_NUMBER(8, r.y);
+		r.w = LIT_GET_NUMBER(9, r.w);
+		r.h = LIT_GET_NUMBER(10, r.h);
+	}
+
+	SDL_Color color = batch->color;
+	uint color_index = offset == 0 ? 11 : 8;
+
+	if (arg_count > color_index) {
+		tsab_color_read(vm, 1, args + color_index, &color);
+	}
+
+	tsab_batch_add(batch->batch, &r, x, y, ox, oy, a, sx, sy, color);
+	return NUMBER_VALUE(batch->batch->count - 1);
+}
+
+/*
+ * Adds a sprite per every stride values of a flat array, laid out as x, y, angle, scale x, scale y
+ * (stride defaults to 2, anything past it uses the defaults)
+ */
+LIT_METHOD(sprite_batch_add_many) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (arg_count < 1 || !IS_ARRAY(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected array as argument #1");
+	}
+
+	LitValues* values = &AS_ARRAY(args[0])->values;
+	int stride = LIT_GET_NUMBER(1, 2);
+
+	if (stride < 2 || stride > 5) {
+		lit_runtime_error_exiting(vm, "Stride has to be between 2 and 5");
+	}
+
+	uint count = values->count / stride;
+	LitValue* value = values->values;
+
+	batch->batch->vertices.reserve((batch->batch->count + count) * 4 * BATCH_VERTEX_SIZE);
+
+	for (uint i = 0; i < count; i++) {
+		float entry[5] = { 0, 0, 0, 1, 1 };
+
+		for (int j = 0; j < stride; j++) {
+			if (IS_NUMBER(value[j])) {
+				entry[j] = AS_NUMBER(value[j]);
+			}
+		}
+
+		if (stride == 4) {
+			entry[4] = entry[3];
+		}
+
+		tsab_batch_add(batch->batch, &batch->region, entry[0], entry[1], batch->origin_x, batch->origin_y, entry[2], entry[3], entry[4], batch->color);
+		value += stride;
+	}
+
+	return NUMBER_VALUE(count);
+}
+
+/*
+ * addTransforms(transforms, scale, stride)
+ * Takes the array filled by Physics.getTransforms: x, y and the angle in radians every stride values (3 by default),
+ * positions get multiplied by scale
+ */
+LIT_METHOD(sprite_batch_add_transforms) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (arg_count < 1 || !IS_ARRAY(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected array as argument #1");
+	}
+
+	LitValues* values = &AS_ARRAY(args[0])->values;
+	float scale = LIT_GET_NUMBER(1, 1);
+	int stride = LIT_GET_NUMBER(2, 3);
+
+	if (stride < 3) {
+		lit_runtime_error_exiting(vm, "Stride has to be at least 3");
+	}
+
+	uint count = values->count / stride;
+	LitValue* value = values->values;
+
+	batch->batch->vertices.reserve((batch->batch->count + count) * 4 * BATCH_VERTEX_SIZE);
+
+	for (uint i = 0; i < count; i++) {
+		if (!IS_NUMBER(value[0]) || !IS_NUMBER(value[1]) || !IS_NUMBER(value[2])) {
+			lit_runtime_error_exiting(vm, "Expected numbers in the transform array");
+		}
+
+		float x = AS_NUMBER(value[0]) * scale;
+		float y = AS_NUMBER(value[1]) * scale;
+		float a = AS_NUMBER(value[2]) * 180.0f / M_PI;
+
+		tsab_batch_add(batch->batch, &batch->region, x, y, batch->origin_x, batch->origin_y, a, 1, 1, batch->color);
+		value += stride;
+	}
+
+	return NUMBER_VALUE(count);
+}
+
+LIT_METHOD(sprite_batch_clear) {
+	LIT_EXTRACT_DATA(SpriteBatch)->batch->count = 0;
+	return NULL_VALUE;
+}
+
+LIT_METHOD(sprite_batch_draw) {
+	if (tsab_graphics_is_headless()) {
+		tsab_graphics_count_draw();
+		return NULL_VALUE;
+	}
+
+	tsab_batch_draw(LIT_EXTRACT_DATA(SpriteBatch)->batch, tsab_graphics_get_current_target());
+	return NULL_VALUE;
+}
+
+LIT_METHOD(sprite_batch_set_color) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (!tsab_color_read(vm, arg_count, args, &batch->color)) {
+		batch->color = { 255, 255, 255, 255 };
+	}
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(sprite_batch_set_region) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (arg_count == 1 && IS_INSTANCE(args[0])) {
+		TextureRegion* region = LIT_EXTRACT_DATA_FROM(args[0], TextureRegion);
+
+		if (region->texture != batch->batch->texture) {
+			lit_runtime_error_exiting(vm, "The region belongs to a different texture than the batch");
+		}
+
+		batch->region = GPU_MakeRect(region->x, region->y, region->w, region->h);
+	} else {
+		batch->region = GPU_MakeRect(LIT_CHECK_NUMBER(0), LIT_CHECK_NUMBER(1), LIT_CHECK_NUMBER(2), LIT_CHECK_NUMBER(3));
+	}
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(sprite_batch_count) {
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(SpriteBatch)->batch->count);
+}
+
+LIT_METHOD(sprite_batch_origin_x) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (arg_count == 0) {
+		return NUMBER_VALUE(batch->origin_x);
+	}
+
+	batch->origin_x = LIT_CHECK_NUMBER(0);
+	return args[0];
+}
+
+LIT_METHOD(sprite_batch_origin_y) {
+	SpriteBatch* batch = LIT_EXTRACT_DATA(SpriteBatch);
+
+	if (arg_count == 0) {
+		return NUMBER_VALUE(batch->origin_y);
+	}
+
+	batch->origin_y = LIT_CHECK_NUMBER(0);
+	return args[0];
+}
+
+void tsab_sprite_batch_bind_api(LitState* state) {
+	LIT_BEGIN_CLASS("SpriteBatch")
+		LIT_BIND_CONSTRUCTOR(sprite_batch_constructor)
+
+		LIT_BIND_METHOD("add", sprite_batch_add)
+		LIT_BIND_METHOD("addMany", sprite_batch_add_many)
+		LIT_BIND_METHOD("addTransforms", sprite_batch_add_transforms)
+		LIT_BIND_METHOD("clear", sprite_batch_clear)
+		LIT_BIND_METHOD("draw", sprite_batch_draw)
+		LIT_BIND_METHOD("setColor", sprite_batch_set_color)
+		LIT_BIND_METHOD("setRegion", sprite_batch_set_region)
+
+		LIT_BIND_GETTER("count", sprite_batch_count)
+		LIT_BIND_FIELD("originX", sprite_batch_origin_x, sprite_batch_origin_x)
+		LIT_BIND_FIELD("originY", sprite_batch_origin_y, sprite_batch_origin_y)
+	LIT_END_CLASS()
+}
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include <tsab/graphics/tsab_text.hpp>
+#include <tsab/graphics/tsab_graphics.hpp>
+#include <tsab/graphics/tsab_texture_region.hpp>
+#include <tsab/tsab_shaders.hpp>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Retained text cache behind Graphics.print/printf
+ */
+
+typedef struct {
+	uint64_t hash;
+	FontAtlas* font;
+	float wrap;
+	std::string text;
+
+	GPU_Image* image;
+	size_t bytes;
+	uint uses;
+	bool failed; // The bake failed, stay on the glyph path instead of retrying every draw
+} CachedText;
+
+static std::list<CachedText> cache_entries; // Most recently used first
+static std::unordered_map<uint64_t, std::list<CachedText>::iterator> cache_lookup;
+static size_t cache_bytes = 0;
+static size_t cache_budget = 4 * 1024 * 1024;
+
+static uint64_t hash_text(FontAtlas* font, const char* text, float wrap) {
+	// FNV-1a, so that lookups don't have to allocate a key
+	uint64_t hash = 14695981039346656037ULL;
+
+	while (*text != '\0') {
+		hash = (hash ^ (unsigned char) *text++) * 1099511628211ULL;
+	}
+
+	hash ^= (uint64_t) (uintptr_t) font * 31;
+	hash ^= (uint64_t) (wrap * 1000) << 32;
+
+	return hash;
+}
+
+static void free_entry(std::list<CachedText>::iterator entry) {
+	if (entry->image != nullptr) {
+		GPU_FreeImage(entry->image);
+	}
+
+	cache_bytes -= entry->bytes;
+	cache_lookup.erase(entry->hash);
+	cache_entries.erase(entry);
+}
+
+static void evict() {
+	while (cache_bytes > cache_budget && !cache_entries.empty()) {
+		free_entry(std::prev(cache_entries.end()));
+	}
+}
+
+bool tsab_text_cache_draw(FontAtlas* font, GPU_Target* target, const char* text, float x, float y, float wrap, float r, float sx, float sy, SDL_Color color) {
+	if (cache_budget == 0) {
+		return false;
+	}
+
+	uint64_t hash = hash_text(font, text, wrap);
+	auto iterator = cache_lookup.find(hash);
+
+	if (iterator != cache_lookup.end()) {
+		auto entry = iterator->second;
+
+		if (entry->font != font || entry->wrap != wrap || entry->text != text) {
+			// Hash collision, the new text takes over the slot
+			free_entry(entry);
+		} else {
+			cache_entries.splice(cache_entries.begin(), cache_entries, entry);
+
+			// Only bake text, that is being reused, so that ever-changing strings stay on the glyph atlas path
+			if (entry->image == nullptr && !entry->failed && ++entry->uses >= 2) {
+				entry->image = tsab_font_bake(font, text, wrap);
+
+				if (entry->image == nullptr) {
+					entry->failed = true;
+				} else {
+					size_t bytes = entry->image->w * entry->image->h * 4;
+
+					entry->bytes += bytes;
+					cache_bytes += bytes;
+				}
+			}
+
+			GPU_Image* image = entry->image;
+
+			if (image == nullptr) {
+				return false;
+			}
+
+			tsab_shaders_set_textured(true);
+			GPU_SetRGBA(image, color.r, color.g, color.b, color.a);
+			GPU_BlitTransformX(image, nullptr, target, x + image->w / 2.0f, y + image->h / 2.0f, image->w / 2.0f, image->h / 2.0f, r, sx, sy);
+
+			evict();
+			return true;
+		}
+	}
+
+	cache_entries.push_front((CachedText) {
+		hash, font, wrap, std::string(text), nullptr, 0, 1, false
+	});
+
+	auto entry = cache_entries.begin();
+
+	entry->bytes = sizeof(CachedText) + entry->text.size();
+	cache_bytes += entry->bytes;
+	cache_lookup[hash] = entry;
+
+	evict();
+	return false;
+}
+
+void tsab_text_cache_set_budget(size_t bytes) {
+	cache_budget = bytes;
+	evict();
+}
+
+void tsab_text_quit() {
+	while (!cache_entries.empty()) {
+		free_entry(cache_entries.begin());
+	}
+}
+
+/*
+ * Text class
+ */
+
+typedef struct {
+	// Has to go first, so that Graphics.draw can use a Text as a TextureRegion
+	TextureRegion region;
+
+	FontAtlas* font;
+	float wrap;
+	LitValue string;
+} Text;
+
+void cleanup_text(LitState* state, LitUserdata* data, bool mark) {
+	auto text = (Text*) data->data;
+
+	if (mark) {
+		lit_mark_value(state->vm, text->string);
+		return;
+	}
+
+	if (text->region.texture != nullptr) {
+		GPU_FreeImage(text->region.texture);
+		text->region.texture = nullptr;
+	}
+}
+
+static void bake_text(Text* text) {
+	if (text->region.texture != nullptr) {
+		GPU_FreeImage(text->region.texture);
+	}
+
+	GPU_Image* image = tsab_font_bake(text->font, AS_CSTRING(text->string), text->wrap);
+
+	text->region.texture = image;
+	text->region.x = 0;
+	text->region.y = 0;
+	text->region.w = image == nullptr ? 0 : image->w;
+	text->region.h = image == nullptr ? 0 : image->h;
+}
+
+LIT_METHOD(text_constructor) {
+	LitString* string = LIT_CHECK_OBJECT_STRING(0);
+	FontAtlas* font = tsab_graphics_get_font();
+
+	if (font == nullptr) {
+		lit_runtime_error_exiting(vm, "No font to render text with");
+	}
+
+	Text* text = LIT_INSERT_DATA(Text, cleanup_text);
+
+	text->region.texture = nullptr;
+	text->font = font;
+	text->wrap = LIT_GET_NUMBER(1, 0);
+	text->string = OBJECT_VALUE(string);
+
+	bake_text(text);
+	return instance;
+}
+
+LIT_METHOD(text_text) {
+	Text* text = LIT_EXTRACT_DATA(Text);
+
+	if (arg_count == 0) {
+		return text->string;
+	}
+
+	LitString* string = LIT_CHECK_OBJECT_STRING(0);
+
+	if (OBJECT_VALUE(string) != text->string) {
+		text->string = OBJECT_VALUE(string);
+		bake_text(text);
+	}
+
+	return args[0];
+}
+
+LIT_METHOD(text_wrap) {
+	Text* text = LIT_EXTRACT_DATA(Text);
+
+	if (arg_count == 0) {
+		return NUMBER_VALUE(text->wrap);
+	}
+
+	float wrap = LIT_CHECK_NUMBER(0);
+
+	if (wrap != text->wrap) {
+		text->wrap = wrap;
+		bake_text(text);
+	}
+
+	return args[0];
+}
+
+LIT_METHOD(text_width) {
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Text)->region.w);
+}
+
+LIT_METHOD(text_height) {
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Text)->region.h);
+}
+
+LIT_METHOD(text_draw) {
+	Text* text = LIT_EXTRACT_DATA(Text);
+	GPU_Image* image = text->region.texture;
+
+	if (tsab_graphics_is_headless()) {
+		tsab_graphics_count_draw();
+		return NULL_VALUE;
+	}
+
+	if (image == nullptr) {
+		return NULL_VALUE;
+	}
+
+	double x = LIT_GET_NUMBER(0, 0);
+	double y = LIT_GET_NUMBER(1, 0);
+	double r = LIT_GET_NUMBER(2, 0);
+	double sx = LIT_GET_NUMBER(3, 1);
+	double sy = LIT_GET_NUMBER(4, 1);
+
+	SDL_Color color = tsab_graphics_get_color();
+	tsab_shaders_set_textured(true);
+
+	GPU_SetRGBA(image, color.r, color.g, color.b, color.a);
+	GPU_BlitTransformX(image, nullptr, tsab_graphics_get_current_target(), x + image->w / 2.0f, y + image->h / 2.0f, image->w / 2.0f, image->h / 2.0f, r, sx, sy);
+
+	return NULL_VALUE;
+}
+
+void tsab_text_bind_api(LitState* state) {
+	LIT_BEGIN_CLASS("Text")
+		LIT_BIND_CONSTRUCTOR(text_constructor)
+
+		LIT_BIND_FIELD("text", text_text, text_text)
+		LIT_BIND_FIELD("wrap", text_wrap, text_wrap)
+		LIT_BIND_GETTER("width", text_width)
+		LIT_BIND_GETTER("height", text_height)
+
+		LIT_BIND_METHOD("draw", text_draw)
+	LIT_END_CLASS()
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include <tsab/graphics/tsab_tilemap.hpp>
 #include <tsab/graphics/tsab_graphics.hpp>
+#include <tsab/graphics/tsab_batch.hpp>
+#include <tsab/graphics/tsab_map_format.hpp>
+#include <tsab/graphics/tsab_atlas.hpp>
 #include <tsab/tsab.hpp>
 
 #define CUTE_TILED_IMPLEMENTATION
@@ -10,192 +13,945 @@
 
 #include <math.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+// Size of a pre-rendered chunk, in tiles
+#define CHUNK_SIZE 32
+// How many different layer selections keep their own baked chunks
+#define COMPOSITE_MAX 4
+
+#define TILE_FLIPPED_HORIZONTALLY 0x80000000
+#define TILE_FLIPPED_VERTICALLY 0x40000000
+#define TILE_FLIPPED_DIAGONALLY 0x20000000
+#define TILE_GID_MASK 0x1FFFFFFF
+
+typedef struct {
+	GPU_Image* image;
+	bool dirty;
+} TileChunk;
+
+typedef struct {
+	const char* name;
+	uint32_t* data;
+	bool visible;
+
+	TileChunk* chunks;
+} TileLayer;
+
+// Several layers baked into the same chunk canvases, so that drawing all of them is a blit per chunk
+typedef struct {
+	std::vector<int> layers;
+	TileChunk* chunks;
+} TileComposite;
+
 typedef struct {
 	GPU_Image* texture;
+	// Where the tileset starts inside of its atlas page
+	int x;
+	int y;
+	// Tilesets, that ended up on the same page, share the batch of the first one
+	int batch;
+
+	uint32_t first_gid;
+	uint32_t tile_count;
+
+	int columns;
+	int tile_width;
+	int tile_height;
+	int margin;
+	int spacing;
+} Tileset;
 
+typedef struct {
+	// Only one of them is set, depending on the map format
 	cute_tiled_map_t* map;
-	cute_tiled_layer_t* tiles;
+	void* file;
+	size_t file_size;
+
+	int width;
+	int height;
+	int tile_width;
+	int tile_height;
+
+	std::vector<TileLayer>* layers;
+	std::vector<TileComposite>* composites;
+	std::vector<Tileset>* tilesets;
+	// Gid -> index of its tileset + 1 (0 means no tileset)
+	std::vector<uint16_t>* gid_to_tileset;
+
+	// The layer, that was picked in the constructor, or -1
+	int default_layer;
+
+	int chunks_x;
+	int chunks_y;
 } Tilemap;
 
-void cleanup_tilemap(LitState* state, LitUserdata* d, bool mark) {
-	if (mark) {
-		return;
+// Tileset textures are shared between all the maps, that use them
+static std::unordered_map<std::string, AtlasRegion> tileset_textures;
+static std::vector<QuadBatch> bake_batches;
+// The layers picked by the current render() call
+static std::vector<int> selected_layers;
+
+static bool load_tileset_texture(const char* path, AtlasRegion* region) {
+	auto iterator = tileset_textures.find(path);
+
+	if (iterator != tileset_textures.end()) {
+		*region = iterator->second;
+		return true;
 	}
 
-	auto map = (Tilemap*) d->data;
-	cute_tiled_free_map(map->map);
+	if (!tsab_atlas_load(path, region)) {
+		return false;
+	}
+
+	tileset_textures[path] = *region;
+	return true;
 }
 
-LIT_METHOD(tilemap_constructor) {
-	const char* path = LIT_CHECK_STRING(0);
-	const char* layer_name = LIT_CHECK_STRING(1);
+static TileChunk* create_chunks(Tilemap* tilemap) {
+	auto chunks = new TileChunk[tilemap->chunks_x * tilemap->chunks_y];
+
+	for (int i = 0; i < tilemap->chunks_x * tilemap->chunks_y; i++) {
+		chunks[i] = (TileChunk) { nullptr, true };
+	}
+
+	return chunks;
+}
+
+static void free_chunks(Tilemap* tilemap, TileChunk* chunks) {
+	for (int i = 0; i < tilemap->chunks_x * tilemap->chunks_y; i++) {
+		if (chunks[i].image != nullptr) {
+			GPU_FreeImage(chunks[i].image);
+		}
+	}
+
+	delete[] chunks;
+}
+
+static void add_layer(Tilemap* tilemap, const char* name, uint32_t* data, bool visible) {
+	tilemap->layers->push_back((TileLayer) { name, data, visible, create_chunks(tilemap) });
+}
+
+static void add_tileset(LitVm* vm, Tilemap* tilemap, const std::string& directory, const char* name, const char* image, uint32_t first_gid, uint32_t tile_count, int columns, int tile_width, int tile_height, int margin, int spacing) {
+	std::string texture_path = directory;
+
+	if (image != nullptr && image[0] != '\0') {
+		texture_path += image;
+	} else {
+		texture_path += std::string(name) + ".png";
+	}
+
+	AtlasRegion region;
+
+	if (!load_tileset_texture(texture_path.c_str(), &region)) {
+		lit_runtime_error_exiting(vm, "Failed to find tile texture %s", texture_path.c_str());
+	}
+
+	if (columns <= 0) {
+		columns = fmax(1, (region.w - margin * 2 + spacing) / (tile_width + spacing));
+	}
+
+	int batch = tilemap->tilesets->size();
+
+	for (uint i = 0; i < tilemap->tilesets->size(); i++) {
+		if ((*tilemap->tilesets)[i].texture == region.texture) {
+			batch = i;
+			break;
+		}
+	}
+
+	tilemap->tilesets->push_back((Tileset) { region.texture, region.x, region.y, batch, first_gid, tile_count, columns, tile_width, tile_height, margin, spacing });
+
+	auto gids = tilemap->gid_to_tileset;
+	uint32_t last_gid = first_gid + tile_count;
+
+	if (gids->size() < last_gid) {
+		gids->resize(last_gid, 0);
+	}
+
+	for (uint32_t gid = first_gid; gid < last_gid; gid++) {
+		(*gids)[gid] = tilemap->tilesets->size();
+	}
+}
+
+// Field names of the object callback argument, interned once per load
+typedef struct {
+	LitString* name;
+	LitString* type;
+	LitString* x;
+	LitString* y;
+	LitString* width;
+	LitString* height;
+} ObjectFields;
+
+#define OBJECT_FIELD_COUNT 6
+
+static LitString* intern_root(LitState* state, const char* chars) {
+	LitString* string = CONST_STRING(state, chars);
+	lit_push_root(state, (LitObject*) string);
+
+	return string;
+}
+
+/*
+ * The names stay rooted, until the caller pops OBJECT_FIELD_COUNT roots
+ */
+static void intern_object_fields(LitState* state, ObjectFields* fields) {
+	fields->name = intern_root(state, "name");
+	fields->type = intern_root(state, "type");
+	fields->x = intern_root(state, "x");
+	fields->y = intern_root(state, "y");
+	fields->width = intern_root(state, "width");
+	fields->height = intern_root(state, "height");
+}
+
+static void call_object_callback(LitState* state, ObjectFields* names, LitValue callee, LitValue* ar, const char* name, const char* type, float x, float y, float width, float height) {
+	LitTable* fields = &AS_INSTANCE(ar[0])->fields;
+
+	lit_table_set(state, fields, names->name, OBJECT_VALUE(intern_root(state, name)));
+	lit_table_set(state, fields, names->type, OBJECT_VALUE(intern_root(state, type)));
+	lit_pop_roots(state, 2);
+
+	lit_table_set(state, fields, names->x, NUMBER_VALUE(x));
+	lit_table_set(state, fields, names->y, NUMBER_VALUE(y));
+	lit_table_set(state, fields, names->width, NUMBER_VALUE(width));
+	lit_table_set(state, fields, names->height, NUMBER_VALUE(height));
+
+	tsab_handle_call(lit_call(state, callee, ar, 2));
+}
 
+/*
+ * Tiled JSON maps, parsed with cute_tiled
+ */
+
+static void collect_tile_layers(Tilemap* tilemap, cute_tiled_layer_t* layer) {
+	while (layer != nullptr) {
+		if (layer->layers != nullptr) {
+			collect_tile_layers(tilemap, layer->layers);
+		} else if (layer->data != nullptr) {
+			add_layer(tilemap, layer->name.ptr, (uint32_t*) layer->data, layer->visible != 0);
+		}
+
+		layer = layer->next;
+	}
+}
+
+static void call_json_objects(LitState* state, ObjectFields* names, LitValue callee, cute_tiled_layer_t* layer) {
+	while (layer != nullptr) {
+		if (layer->layers != nullptr) {
+			call_json_objects(state, names, callee, layer->layers);
+		} else if (layer->objects != nullptr) {
+			auto object = layer->objects;
+			LitInstance* properties = lit_create_instance(state, state->object_class);
+
+			lit_push_root(state, (LitObject*) properties);
+
+			LitValue ar[2] = {
+				OBJECT_VALUE(properties), OBJECT_VALUE(intern_root(state, layer->name.ptr))
+			};
+
+			while (object != nullptr) {
+				call_object_callback(state, names, callee, ar, object->name.ptr, object->type.ptr, object->x, object->y, object->width, object->height);
+				object = object->next;
+			}
+
+			lit_pop_roots(state, 2);
+		}
+
+		layer = layer->next;
+	}
+}
+
+static void load_json_map(LitVm* vm, Tilemap* data, const char* path, const std::string& directory) {
 	cute_tiled_map_t* map = cute_tiled_load_map_from_file(path, nullptr);
 
 	if (map == nullptr) {
 		lit_runtime_error_exiting(vm, "Failed to load map %s", path);
 	}
 
-	cute_tiled_layer_t* tiles = map->layers;
+	data->map = map;
+	data->width = map->width;
+	data->height = map->height;
+	data->tile_width = map->tilewidth;
+	data->tile_height = map->tileheight;
+	data->chunks_x = (map->width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	data->chunks_y = (map->height + CHUNK_SIZE - 1) / CHUNK_SIZE;
 
-	while (tiles != nullptr) {
-		if (tiles->data != nullptr && strcmp(tiles->name.ptr, layer_name) == 0) {
-			break;
+	collect_tile_layers(data, map->layers);
+
+	auto tileset = map->tilesets;
+
+	while (tileset != nullptr) {
+		add_tileset(vm, data, directory, tileset->name.ptr, tileset->image.ptr, tileset->firstgid, tileset->tilecount,
+			tileset->columns, tileset->tilewidth, tileset->tileheight, tileset->margin, tileset->spacing);
+
+		tileset = tileset->next;
+	}
+}
+
+/*
+ * Binary maps (see tsab_map_format.hpp), used straight from the mapped file
+ */
+
+static bool map_file(const char* path, void** memory, size_t* size) {
+#ifdef _WIN32
+	FILE* file = fopen(path, "rb");
+
+	if (file == nullptr) {
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	*memory = malloc(*size);
+
+	if (*memory == nullptr || fread(*memory, 1, *size, file) != *size) {
+		free(*memory);
+		fclose(file);
+
+		return false;
+	}
+
+	fclose(file);
+	return true;
+#else
+	int file = open(path, O_RDONLY);
+
+	if (file == -1) {
+		return false;
+	}
+
+	struct stat info;
+
+	if (fstat(file, &info) == -1 || info.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	*size = info.st_size;
+	// Private mapping, so that setTile can write into the tiles without touching the file
+	*memory = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+
+	close(file);
+	return *memory != MAP_FAILED;
+#endif
+}
+
+static void unmap_file(void* memory, size_t size) {
+#ifdef _WIN32
+	free(memory);
+#else
+	munmap(memory, size);
+#endif
+}
+
+static bool is_binary_map(void* memory, size_t size) {
+	return size >= sizeof(MapFileHeader) && ((MapFileHeader*) memory)->magic == TSAB_MAP_MAGIC;
+}
+
+static bool fits_in_file(size_t size, uint64_t offset, uint64_t length) {
+	return offset % 4 == 0 && offset + length <= size;
+}
+
+static bool validate_binary_map(void* memory, size_t size) {
+	auto header = (MapFileHeader*) memory;
+	auto base = (uint8_t*) memory;
+
+	if (header->version != TSAB_MAP_VERSION || header->strings_size == 0) {
+		return false;
+	}
+
+	if (!fits_in_file(size, header->tilesets_offset, (uint64_t) header->tileset_count * sizeof(MapFileTileset))
+		|| !fits_in_file(size, header->layers_offset, (uint64_t) header->layer_count * sizeof(MapFileLayer))
+		|| !fits_in_file(size, header->objects_offset, (uint64_t) header->object_count * sizeof(MapFileObject))
+		|| header->strings_offset + (uint64_t) header->strings_size > size
+		|| base[header->strings_offset + header->strings_size - 1] != '\0') {
+
+		return false;
+	}
+
+	auto layers = (MapFileLayer*) (base + header->layers_offset);
+	uint64_t layer_size = (uint64_t) header->width * header->height * sizeof(uint32_t);
+
+	for (uint i = 0; i < header->layer_count; i++) {
+		if (!fits_in_file(size, layers[i].data_offset, layer_size)) {
+			return false;
 		}
+	}
 
-		tiles = tiles->next;
+	return true;
+}
+
+static const char* get_binary_string(MapFileHeader* header, uint32_t offset) {
+	if (offset >= header->strings_size) {
+		return "";
 	}
 
-	if (tiles == nullptr) {
-		lit_runtime_error_exiting(vm, "Failed to find tile layer %s", layer_name);
+	return (const char*) header + header->strings_offset + offset;
+}
+
+static void load_binary_map(LitVm* vm, Tilemap* data, const char* path, const std::string& directory) {
+	if (!validate_binary_map(data->file, data->file_size)) {
+		lit_runtime_error_exiting(vm, "Map %s is corrupted or was made for another version", path);
 	}
 
-	Tilemap* data = LIT_INSERT_DATA(Tilemap, nullptr);
+	auto header = (MapFileHeader*) data->file;
+	auto base = (uint8_t*) data->file;
 
-	data->map = map;
-	data->tiles = tiles;
+	data->width = header->width;
+	data->height = header->height;
+	data->tile_width = header->tile_width;
+	data->tile_height = header->tile_height;
+	data->chunks_x = (header->width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	data->chunks_y = (header->height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	auto layers = (MapFileLayer*) (base + header->layers_offset);
+
+	for (uint i = 0; i < header->layer_count; i++) {
+		add_layer(data, get_binary_string(header, layers[i].name), (uint32_t*) (base + layers[i].data_offset), layers[i].visible != 0);
+	}
+
+	auto tilesets = (MapFileTileset*) (base + header->tilesets_offset);
+
+	for (uint i = 0; i < header->tileset_count; i++) {
+		auto tileset = &tilesets[i];
+
+		add_tileset(vm, data, directory, get_binary_string(header, tileset->name), get_binary_string(header, tileset->image), tileset->first_gid,
+			tileset->tile_count, tileset->columns, tileset->tile_width, tileset->tile_height, tileset->margin, tileset->spacing);
+	}
+}
 
-	// Complex path manipulation, basically a/b/map.json -> a/b/tiles.png
+static void call_binary_objects(LitState* state, ObjectFields* names, LitValue callee, MapFileHeader* header) {
+	auto objects = (MapFileObject*) ((uint8_t*) header + header->objects_offset);
+	LitValue ar[2];
+	uint32_t layer = UINT32_MAX;
+
+	for (uint i = 0; i < header->object_count; i++) {
+		auto object = &objects[i];
+
+		if (object->layer != layer) {
+			if (layer != UINT32_MAX) {
+				lit_pop_roots(state, 2);
+			}
+
+			layer = object->layer;
+			LitInstance* properties = lit_create_instance(state, state->object_class);
+
+			lit_push_root(state, (LitObject*) properties);
+
+			ar[0] = OBJECT_VALUE(properties);
+			ar[1] = OBJECT_VALUE(intern_root(state, get_binary_string(header, layer)));
+		}
+
+		call_object_callback(state, names, callee, ar, get_binary_string(header, object->name), get_binary_string(header, object->type),
+			object->x, object->y, object->width, object->height);
+	}
+
+	if (layer != UINT32_MAX) {
+		lit_pop_roots(state, 2);
+	}
+}
+
+void cleanup_tilemap(LitState* state, LitUserdata* d, bool mark) {
+	if (mark) {
+		return;
+	}
+
+	auto map = (Tilemap*) d->data;
+
+	for (auto & layer : *map->layers) {
+		free_chunks(map, layer.chunks);
+	}
+
+	for (auto & composite : *map->composites) {
+		free_chunks(map, composite.chunks);
+	}
+
+	delete map->layers;
+	delete map->composites;
+	delete map->tilesets;
+	delete map->gid_to_tileset;
+
+	if (map->map != nullptr) {
+		cute_tiled_free_map(map->map);
+	}
+
+	if (map->file != nullptr) {
+		unmap_file(map->file, map->file_size);
+	}
+}
+
+static int find_layer_by_name(Tilemap* tilemap, const char* name) {
+	auto layers = tilemap->layers;
+
+	for (uint i = 0; i < layers->size(); i++) {
+		if (strcmp((*layers)[i].name, name) == 0) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Finds the layer by its name or index, returns -1 if there is no such tile layer
+ */
+static int find_layer(Tilemap* tilemap, LitValue value) {
+	if (IS_NUMBER(value)) {
+		int index = AS_NUMBER(value);
+		return index >= 0 && index < (int) tilemap->layers->size() ? index : -1;
+	}
+
+	if (IS_STRING(value)) {
+		return find_layer_by_name(tilemap, AS_CSTRING(value));
+	}
+
+	return -1;
+}
+
+/*
+ * Tilemap(path, layer?, callback?)
+ * The path can point either to a Tiled JSON map, or to one converted with mapconvert
+ */
+LIT_METHOD(tilemap_constructor) {
+	const char* path = LIT_CHECK_STRING(0);
+	const char* layer_name = nullptr;
+	int callback_index = -1;
+
+	for (uint i = 1; i < arg_count && i < 3; i++) {
+		if (IS_STRING(args[i])) {
+			layer_name = AS_CSTRING(args[i]);
+		} else if (IS_CALLABLE_FUNCTION(args[i])) {
+			callback_index = i;
+		}
+	}
+
+	Tilemap* data = LIT_INSERT_DATA(Tilemap, cleanup_tilemap);
+
+	data->map = nullptr;
+	data->file = nullptr;
+	data->file_size = 0;
+	data->layers = new std::vector<TileLayer>();
+	data->composites = new std::vector<TileComposite>();
+	data->tilesets = new std::vector<Tileset>();
+	data->gid_to_tileset = new std::vector<uint16_t>();
+	data->default_layer = -1;
+	data->chunks_x = 0;
+	data->chunks_y = 0;
+
+	// Tileset images are relative to the map, a/b/map.json + tiles.png -> a/b/tiles.png
 	const char* index = strrchr(path, '/');
-	auto tileset_name = map->tilesets->name.ptr;
+	std::string directory = index == nullptr ? "" : std::string(path, index - path + 1);
 
-	int path_length = index == nullptr ? 0 : strlen(path) - strlen(index) + 1;
-	int ending_length = strlen(tileset_name);
+	void* file;
+	size_t file_size;
 
-	char texture_path[path_length + ending_length + 5];
+	if (map_file(path, &file, &file_size)) {
+		if (is_binary_map(file, file_size)) {
+			data->file = file;
+			data->file_size = file_size;
+		} else {
+			unmap_file(file, file_size);
+		}
+	}
 
-	memcpy(texture_path, path, path_length);
-	memcpy(texture_path + path_length, tileset_name, ending_length);
-	memcpy(texture_path + path_length + ending_length, ".png\0", 5);
+	if (data->file != nullptr) {
+		load_binary_map(vm, data, path, directory);
+	} else {
+		load_json_map(vm, data, path, directory);
+	}
 
-	auto texture = GPU_LoadImage(texture_path);
+	if (layer_name != nullptr) {
+		data->default_layer = find_layer_by_name(data, layer_name);
 
-	if (texture == nullptr) {
-		lit_runtime_error_exiting(vm, "Failed to find tile texture %s", texture_path);
+		if (data->default_layer == -1) {
+			lit_runtime_error_exiting(vm, "Failed to find tile layer %s", layer_name);
+		}
 	}
 
-	data->texture = texture;
+	if (callback_index > 0) {
+		ObjectFields names;
+		intern_object_fields(vm->state, &names);
 
-	GPU_SetImageFilter(texture, GPU_FILTER_NEAREST);
-	GPU_SetAnchor(texture, 0, 0); // Aka origin
-	tsab_graphics_add_image(texture);
+		if (data->file != nullptr) {
+			call_binary_objects(vm->state, &names, args[callback_index], (MapFileHeader*) data->file);
+		} else {
+			call_json_objects(vm->state, &names, args[callback_index], data->map->layers);
+		}
 
-	if (arg_count > 2 && IS_CALLABLE_FUNCTION(args[2])) {
-		auto layer = map->layers;
-		auto callee = args[2];
+		lit_pop_roots(vm->state, OBJECT_FIELD_COUNT);
+	}
 
-		LitState* state = vm->state;
+	return instance;
+}
 
-		while (layer != nullptr) {
-			if (layer->objects != nullptr) {
-				auto object = layer->objects;
-				LitInstance* properties = lit_create_instance(state, vm->state->object_class);
+/*
+ * Renders all the tiles of the layers inside of a chunk into its canvas, so that drawing it later is a single blit.
+ * The tiles are batched per tileset, tiles that are taller than the map grid get cut at the chunk edge.
+ */
+static bool bake_chunk(Tilemap* tilemap, TileChunk* chunk, const std::vector<int>& layers, int cx, int cy) {
+	auto tilesets = tilemap->tilesets;
+	auto gids = tilemap->gid_to_tileset;
 
-				LitValue ar[2] = {
-					OBJECT_VALUE(properties), OBJECT_CONST_STRING(state, layer->name.ptr)
-				};
+	int tw = tilemap->tile_width;
+	int th = tilemap->tile_height;
 
-				LitString* name = CONST_STRING(state, "name");
-				LitString* type = CONST_STRING(state, "type");
+	int x = cx * CHUNK_SIZE;
+	int y = cy * CHUNK_SIZE;
+	int w = fmin(CHUNK_SIZE, tilemap->width - x);
+	int h = fmin(CHUNK_SIZE, tilemap->height - y);
 
-				LitString* x = CONST_STRING(state, "x");
-				LitString* y = CONST_STRING(state, "y");
-				LitString* width = CONST_STRING(state, "width");
-				LitString* height = CONST_STRING(state, "height");
+	if (chunk->image == nullptr) {
+		chunk->image = GPU_CreateImage(w * tw, h * th, GPU_FORMAT_RGBA);
 
-				while (object != nullptr) {
-					lit_table_set(state, &properties->fields, name, OBJECT_CONST_STRING(state, object->name.ptr));
-					lit_table_set(state, &properties->fields, type, OBJECT_CONST_STRING(state, object->type.ptr));
+		if (chunk->image == nullptr) {
+			return false;
+		}
 
-					lit_table_set(state, &properties->fields, x, NUMBER_VALUE(object->x));
-					lit_table_set(state, &properties->fields, y, NUMBER_VALUE(object->y));
-					lit_table_set(state, &properties->fields, width, NUMBER_VALUE(object->width));
-					lit_table_set(state, &properties->fields, height, NUMBER_VALUE(object->height));
+		GPU_SetImageFilter(chunk->image, GPU_FILTER_NEAREST);
+		GPU_SetAnchor(chunk->image, 0, 0);
+
+		if (GPU_LoadTarget(chunk->image) == nullptr) {
+			GPU_FreeImage(chunk->image);
+			chunk->image = nullptr;
+
+			return false;
+		}
+	}
 
-					tsab_handle_call(lit_call(state, callee, ar, 2));
-					object = object->next;
+	auto target = chunk->image->target;
+	GPU_Clear(target);
+
+	if (bake_batches.size() < tilesets->size()) {
+		bake_batches.resize(tilesets->size());
+	}
+
+	for (uint l = 0; l < layers.size(); l++) {
+		auto data = (*tilemap->layers)[layers[l]].data;
+
+		for (uint i = 0; i < tilesets->size(); i++) {
+			tsab_batch_begin(&bake_batches[i], (*tilesets)[i].texture);
+		}
+
+		for (int ty = 0; ty < h; ty++) {
+			for (int tx = 0; tx < w; tx++) {
+				uint32_t tile = data[x + tx + (y + ty) * tilemap->width];
+				uint32_t gid = tile & TILE_GID_MASK;
+
+				if (gid == 0 || gid >= gids->size() || (*gids)[gid] == 0) {
+					continue;
 				}
+
+				auto set = &(*tilesets)[(*gids)[gid] - 1];
+
+				uint32_t id = gid - set->first_gid;
+				int sw = set->tile_width;
+				int sh = set->tile_height;
+
+				GPU_Rect r = GPU_MakeRect(
+					set->x + set->margin + id % set->columns * (sw + set->spacing),
+					set->y + set->margin + id / set->columns * (sh + set->spacing),
+					sw, sh
+				);
+
+				bool flip_x = (tile & TILE_FLIPPED_HORIZONTALLY) != 0;
+				bool flip_y = (tile & TILE_FLIPPED_VERTICALLY) != 0;
+
+				float a = 0;
+				float sx = flip_x ? -1 : 1;
+				float sy = flip_y ? -1 : 1;
+				float ox = flip_x ? sw : 0;
+				float oy = flip_y ? sh : 0;
+
+				if (tile & TILE_FLIPPED_DIAGONALLY) {
+					// Transposing is a 90 degree turn with a vertical flip, the other flips get applied after it
+					a = 90;
+					sx = flip_y ? -1 : 1;
+					ox = flip_y ? sw : 0;
+					sy = flip_x ? 1 : -1;
+					oy = flip_x ? sh : 0;
+				}
+
+				// Tiled aligns tiles to the bottom left corner of their cell
+				tsab_batch_add(&bake_batches[set->batch], &r, tx * tw, (ty + 1) * th - sh, ox, oy, a, sx, sy, { 255, 255, 255, 255 });
 			}
+		}
+
+		/*
+		 * Tiles of a layer never overlap, so the first layer gets copied as-is, to keep the alpha intact,
+		 * instead of blending it against the empty canvas. The layers above it are blended over it
+		 */
+		for (uint i = 0; i < tilesets->size(); i++) {
+			auto batch = &bake_batches[i];
+
+			if (batch->count > 0) {
+				if (l == 0) {
+					GPU_SetBlending(batch->texture, false);
+				} else {
+					GPU_SetBlendMode(batch->texture, GPU_BLEND_NORMAL_FACTOR_ALPHA);
+				}
 
-			layer = layer->next;
+				tsab_batch_flush(batch, target);
+
+				GPU_SetBlending(batch->texture, true);
+				GPU_SetBlendMode(batch->texture, GPU_BLEND_NORMAL);
+			}
 		}
 	}
 
-	return instance;
+	chunk->dirty = false;
+	return true;
 }
 
+static void render_chunks(Tilemap* tilemap, TileChunk* chunks, const std::vector<int>& layers, GPU_Target* target, int x, int y, int w, int h) {
+	int tw = tilemap->tile_width;
+	int th = tilemap->tile_height;
+
+	int first_x = x / CHUNK_SIZE;
+	int first_y = y / CHUNK_SIZE;
+	int last_x = (x + w - 1) / CHUNK_SIZE;
+	int last_y = (y + h - 1) / CHUNK_SIZE;
+
+	for (int cy = first_y; cy <= last_y; cy++) {
+		for (int cx = first_x; cx <= last_x; cx++) {
+			auto chunk = &chunks[cx + cy * tilemap->chunks_x];
+
+			if (chunk->dirty && !bake_chunk(tilemap, chunk, layers, cx, cy)) {
+				continue;
+			}
+
+			// Only the part of the chunk, that is inside of the requested area
+			int chunk_x = cx * CHUNK_SIZE;
+			int chunk_y = cy * CHUNK_SIZE;
+			int from_x = fmax(x, chunk_x);
+			int from_y = fmax(y, chunk_y);
+			int to_x = fmin(x + w, chunk_x + CHUNK_SIZE);
+			int to_y = fmin(y + h, chunk_y + CHUNK_SIZE);
+
+			GPU_Rect r = GPU_MakeRect((from_x - chunk_x) * tw, (from_y - chunk_y) * th, (to_x - from_x) * tw, (to_y - from_y) * th);
+			GPU_Blit(chunk->image, &r, target, from_x * tw, from_y * th);
+		}
+	}
+}
+
+/*
+ * The baked chunks for the selected layers, the least recently used selection gets replaced, once there are too many
+ */
+static TileComposite* find_composite(Tilemap* tilemap, const std::vector<int>& layers) {
+	auto composites = tilemap->composites;
+
+	for (uint i = 0; i < composites->size(); i++) {
+		if ((*composites)[i].layers == layers) {
+			// Keep the most recently used one in the front
+			std::rotate(composites->begin(), composites->begin() + i, composites->begin() + i + 1);
+			return &composites->front();
+		}
+	}
+
+	if (composites->size() < COMPOSITE_MAX) {
+		composites->push_back((TileComposite) { layers, create_chunks(tilemap) });
+	} else {
+		auto last = &composites->back();
+
+		last->layers = layers;
+
+		for (int i = 0; i < tilemap->chunks_x * tilemap->chunks_y; i++) {
+			last->chunks[i].dirty = true;
+		}
+	}
+
+	std::rotate(composites->begin(), composites->end() - 1, composites->end());
+	return &composites->front();
+}
+
+/*
+ * render(x, y, w, h)
+ * render(layer | [layers], x, y, w, h)
+ * Without the area only the tiles, that the camera can see, are drawn
+ */
 LIT_METHOD(tilemap_render) {
+	if (tsab_graphics_is_headless()) {
+		tsab_graphics_count_draw();
+		return NULL_VALUE;
+	}
+
 	auto target = tsab_graphics_get_current_target();
 	auto tilemap = LIT_EXTRACT_DATA(Tilemap);
+	auto layers = tilemap->layers;
 
-	// Put as much heavy-accessed variables into locals as we can for speed increase
-	auto texture = tilemap->texture;
-	auto map = tilemap->map;
-	auto data = tilemap->tiles->data;
-	auto tileset = map->tilesets;
+	uint offset = 0;
+	LitValue selection = NULL_VALUE;
 
-	int tw = tileset->tilewidth;
-	int th = tileset->tileheight;
-	int c = tileset->columns;
+	if (arg_count > 0 && (IS_STRING(args[0]) || IS_ARRAY(args[0]))) {
+		selection = args[0];
+		offset = 1;
+	}
 
-	int x = fmax(0, fmin(map->width, LIT_GET_NUMBER(0, 0)));
-	int y = fmax(0, fmin(map->height, LIT_GET_NUMBER(1, 0)));
-	int w = fmax(0, fmin(map->width - x, LIT_GET_NUMBER(2, map->width)));
-	int h = fmax(0, fmin(map->height - y, LIT_GET_NUMBER(3, map->height)));
+	int tw = tilemap->tile_width;
+	int th = tilemap->tile_height;
+
+	int x;
+	int y;
+	int w;
+	int h;
+
+	if (arg_count <= offset) {
+		GPU_Rect visible = tsab_graphics_get_visible_rect();
+
+		x = fmax(0, floorf(visible.x / tw));
+		y = fmax(0, floorf(visible.y / th));
+		w = fmax(0, fmin(tilemap->width, ceilf((visible.x + visible.w) / tw)) - x);
+		h = fmax(0, fmin(tilemap->height, ceilf((visible.y + visible.h) / th)) - y);
+	} else {
+		x = fmax(0, fmin(tilemap->width, LIT_GET_NUMBER(offset, 0)));
+		y = fmax(0, fmin(tilemap->height, LIT_GET_NUMBER(offset + 1, 0)));
+		w = fmax(0, fmin(tilemap->width - x, LIT_GET_NUMBER(offset + 2, tilemap->width)));
+		h = fmax(0, fmin(tilemap->height - y, LIT_GET_NUMBER(offset + 3, tilemap->height)));
+	}
 
-	for (int ty = y; ty < y + h; ty++) {
-		for (int tx = x; tx < x + w; tx++) {
-			int tile = data[tx + ty * map->width];
+	if (w <= 0 || h <= 0) {
+		return NULL_VALUE;
+	}
 
-			if (tile == 0) {
-				continue;
+	selected_layers.clear();
+
+	if (IS_ARRAY(selection)) {
+		LitValues* values = &AS_ARRAY(selection)->values;
+
+		for (uint i = 0; i < values->count; i++) {
+			int index = find_layer(tilemap, values->values[i]);
+
+			if (index > -1) {
+				selected_layers.push_back(index);
 			}
+		}
+	} else if (IS_STRING(selection)) {
+		int index = find_layer(tilemap, selection);
 
-			tile--;
-			GPU_Rect r = GPU_MakeRect(tile % c * tw, tile / c * th, tw, th);
-			GPU_Blit(texture, &r, target, tx * tw, ty * th);
+		if (index > -1) {
+			selected_layers.push_back(index);
+		}
+	} else if (tilemap->default_layer > -1) {
+		selected_layers.push_back(tilemap->default_layer);
+	} else {
+		for (uint i = 0; i < layers->size(); i++) {
+			if ((*layers)[i].visible) {
+				selected_layers.push_back(i);
+			}
 		}
 	}
 
+	if (selected_layers.size() == 1) {
+		render_chunks(tilemap, (*layers)[selected_layers[0]].chunks, selected_layers, target, x, y, w, h);
+	} else if (selected_layers.size() > 1) {
+		render_chunks(tilemap, find_composite(tilemap, selected_layers)->chunks, selected_layers, target, x, y, w, h);
+	}
+
 	return NULL_VALUE;
 }
 
+/*
+ * The layer from the optional argument, falls back to the constructor layer or the first one
+ */
+static TileLayer* get_layer_argument(Tilemap* tilemap, uint arg_count, LitValue* args, uint index) {
+	int layer;
+
+	if (arg_count > index) {
+		layer = find_layer(tilemap, args[index]);
+	} else {
+		layer = tilemap->default_layer > -1 ? tilemap->default_layer : 0;
+	}
+
+	return layer < 0 || layer >= (int) tilemap->layers->size() ? nullptr : &(*tilemap->layers)[layer];
+}
+
 LIT_METHOD(tilemap_get_tile) {
 	int x = LIT_CHECK_NUMBER(0);
 	int y = LIT_CHECK_NUMBER(1);
 
 	auto data = LIT_EXTRACT_DATA(Tilemap);
-	auto map = data->map;
+	auto layer = get_layer_argument(data, arg_count, args, 2);
 
-	if (x < 0 || y < 0 || x >= map->width || y >= map->height) {
+	if (layer == nullptr || x < 0 || y < 0 || x >= data->width || y >= data->height) {
 		return NULL_VALUE;
 	}
 
-	return NUMBER_VALUE(data->tiles->data[x + y * map->width]);
+	return NUMBER_VALUE(layer->data[x + y * data->width]);
 }
 
 LIT_METHOD(tilemap_set_tile) {
 	int x = LIT_CHECK_NUMBER(0);
 	int y = LIT_CHECK_NUMBER(1);
-	int tile = LIT_CHECK_NUMBER(2);
+	uint32_t tile = LIT_CHECK_NUMBER(2);
 
 	auto data = LIT_EXTRACT_DATA(Tilemap);
-	auto map = data->map;
+	auto layer = get_layer_argument(data, arg_count, args, 3);
 
-	if (x < 0 || y < 0 || x >= map->width || y >= map->height) {
+	if (layer == nullptr || x < 0 || y < 0 || x >= data->width || y >= data->height) {
 		return NULL_VALUE;
 	}
 
-	data->tiles->data[x + y * map->width] = tile;
+	uint32_t* slot = &layer->data[x + y * data->width];
+
+	if (*slot != tile) {
+		int chunk = x / CHUNK_SIZE + y / CHUNK_SIZE * data->chunks_x;
+		int index = layer - data->layers->data();
+
+		*slot = tile;
+		layer->chunks[chunk].dirty = true;
+
+		for (auto & composite : *data->composites) {
+			if (std::find(composite.layers.begin(), composite.layers.end(), index) != composite.layers.end()) {
+				composite.chunks[chunk].dirty = true;
+			}
+		}
+	}
+
 	return NULL_VALUE;
 }
 
 LIT_METHOD(tilemap_width) {
-	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->map->width);
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->width);
 }
 
 LIT_METHOD(tilemap_height) {
-	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->map->height);
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->height);
+}
+
+LIT_METHOD(tilemap_tile_width) {
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->tile_width);
+}
+
+LIT_METHOD(tilemap_tile_height) {
+	return NUMBER_VALUE(LIT_EXTRACT_DATA(Tilemap)->tile_height);
+}
+
+LIT_METHOD(tilemap_layers) {
+	auto data = LIT_EXTRACT_DATA(Tilemap);
+	LitState* state = vm->state;
+	LitArray* array = lit_create_array(state);
+
+	lit_push_root(state, (LitObject*) array);
+
+	for (auto & layer : *data->layers) {
+		lit_values_write(state, &array->values, OBJECT_VALUE(intern_root(state, layer.name)));
+		lit_pop_root(state);
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(array);
 }
 
 void tsab_tilemap_bind_api(LitState* state) {
@@ -204,6 +960,9 @@ void tsab_tilemap_bind_api(LitState* state) {
 
 		LIT_BIND_GETTER("width", tilemap_width)
 		LIT_BIND_GETTER("height", tilemap_height)
+		LIT_BIND_GETTER("tileWidth", tilemap_tile_width)
+		LIT_BIND_GETTER("tileHeight", tilemap_tile_height)
+		LIT_BIND_GETTER("layers", tilemap_layers)
 
 		LIT_BIND_METHOD("render", tilemap_render)
 		LIT_BIND_METHOD("getTile", tilemap_get_tile)
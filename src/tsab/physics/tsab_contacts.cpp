@@ -0,0 +1,82 @@
+#include <tsab/physics/tsab_contacts.hpp>
+
+void ContactListener::record(ContactType type, b2Contact* contact) {
+	LitInstance* a = (LitInstance*) contact->GetFixtureA()->GetBody()->GetUserData().pointer;
+	LitInstance* b = (LitInstance*) contact->GetFixtureB()->GetBody()->GetUserData().pointer;
+
+	// Bodies, that are being destroyed, have no instance anymore
+	if (a == nullptr || b == nullptr) {
+		return;
+	}
+
+	ContactEvent event;
+
+	event.type = type;
+	event.a = a;
+	event.b = b;
+	event.normal.Set(0, 0);
+	event.point.Set(0, 0);
+	event.impulse = 0;
+
+	if (type != CONTACT_END) {
+		b2WorldManifold manifold;
+		contact->GetWorldManifold(&manifold);
+
+		event.normal = manifold.normal;
+
+		if (contact->GetManifold()->pointCount > 0) {
+			event.point = manifold.points[0];
+		}
+	}
+
+	last_events[contact] = events.size();
+	events.push_back(event);
+}
+
+void ContactListener::BeginContact(b2Contact* contact) {
+	record(CONTACT_BEGIN, contact);
+}
+
+void ContactListener::EndContact(b2Contact* contact) {
+	record(CONTACT_END, contact);
+}
+
+void ContactListener::PreSolve(b2Contact* contact, const b2Manifold* old_manifold) {
+	if (record_pre_solve) {
+		record(CONTACT_PRE_SOLVE, contact);
+	}
+}
+
+void ContactListener::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) {
+	if (last_events.empty()) {
+		return;
+	}
+
+	auto it = last_events.find(contact);
+
+	if (it == last_events.end()) {
+		return;
+	}
+
+	float strongest = 0;
+
+	for (int i = 0; i < impulse->count; i++) {
+		strongest = fmax(strongest, impulse->normalImpulses[i]);
+	}
+
+	events[it->second].impulse = strongest;
+}
+
+void ContactListener::clear() {
+	events.clear();
+	last_events.clear();
+}
+
+void ContactListener::forget(LitInstance* instance) {
+	for (auto & event : events) {
+		if (event.a == instance || event.b == instance) {
+			event.a = nullptr;
+			event.b = nullptr;
+		}
+	}
+}
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include <tsab/physics/tsab_physics.hpp>
 #include <tsab/physics/tsab_debug_view.hpp>
+#include <tsab/physics/tsab_contacts.hpp>
+#include <tsab/physics/tsab_queries.hpp>
 #include <tsab/tsab.hpp>
+#include <tsab/tsab_profiler.hpp>
 
 #include <box2d/box2d.h>
 #include <SDL.h>
@@ -9,15 +12,60 @@
 
 static b2World* world;
 static DebugView debug;
+static ContactListener contacts;
+static bool contact_callbacks = false;
+
+typedef struct {
+	int velocity_iterations;
+	int position_iterations;
+	// How many steps one update gets split into
+	int sub_steps;
+
+	bool warm_starting;
+	bool continuous;
+	bool allow_sleep;
+
+	// Body defaults
+	float linear_damping;
+	float angular_damping;
+	float density;
+	float restitution;
+	float friction;
+} WorldConfig;
+
+// Stays around between worlds, until it gets changed
+static WorldConfig config = { 8, 3, 1, true, true, true, 0.1f, 0.1f, 1, 0.6f, 0.2f };
+
+// Reused by the queries, so that they don't allocate every call
+static std::vector<RayHit> ray_hits;
+static std::vector<b2Body*> query_bodies;
+// Fields of the hit objects, indexed like the values in write_hit()
+static LitString* hit_fields[6];
+
+// Indexed by ContactType, kept alive with tsab_keep_alive()
+static LitString* contact_kinds[3];
+static LitString* contact_methods[3];
+
+// The body userdata field name, interned once and kept alive the same way
+static LitString* data_string;
+
+// Accessors tend to go over the same body a few times in a row (x, y, angle), so the last lookup is remembered
+static LitInstance* last_instance;
+static LitUserdata* last_data;
+
+static b2Body** extract_body_data_from_instance(LitInstance* instance) {
+	if (instance != last_instance) {
+		LitValue data;
+
+		if (!lit_table_get(&instance->fields, data_string, &data)) {
+			return NULL;
+		}
 
-static b2Body** extract_body_data_from_instance(LitState* state, LitInstance* instance) {
-	LitValue data;
-
-	if (!lit_table_get(&instance->fields, CONST_STRING(state, "_data"), &data)) {
-		return NULL;
+		last_instance = instance;
+		last_data = AS_USERDATA(data);
 	}
 
-	return (b2Body**) &AS_USERDATA(data)->data;
+	return (b2Body**) &last_data->data;
 }
 
 static void destroy_world(LitState* state) {
@@ -25,11 +73,22 @@ static void destroy_world(LitState* state) {
 		b2Body* body = world->GetBodyList();
 
 		while (body != nullptr) {
-			// can be really wrong, i'm not sure, was fixing for tsab-android
-			*extract_body_data_from_instance(state, (LitInstance*) body->GetUserData().pointer) = nullptr;
+			LitInstance* instance = (LitInstance*) body->GetUserData().pointer;
+
+			// Bodies, that are being collected, have no instance anymore
+			if (instance != nullptr) {
+				b2Body** data = extract_body_data_from_instance(instance);
+
+				if (data != nullptr) {
+					*data = nullptr;
+				}
+			}
+
 			body = body->GetNext();
 		}
 
+		contacts.clear();
+
 		b2Joint* joint = world->GetJointList();
 
 		while (joint != nullptr) {
@@ -52,13 +111,13 @@ void tsab_physics_quit(LitState* state) {
  */
 
 static b2Body* extract_body_data(LitState* state, LitValue instance) {
-	LitValue data;
+	b2Body** data = extract_body_data_from_instance(AS_INSTANCE(instance));
 
-	if (!lit_table_get(&AS_INSTANCE(instance)->fields, CONST_STRING(state, "_data"), &data)) {
+	if (data == nullptr) {
 		return NULL;
 	}
 
-	b2Body* body = (b2Body*) AS_USERDATA(data)->data;
+	b2Body* body = *data;
 
 	if (body == nullptr) {
 		lit_runtime_error_exiting(state->vm, "Attempt to access invalid body");
@@ -67,11 +126,36 @@ static b2Body* extract_body_data(LitState* state, LitValue instance) {
 	return body;
 }
 
+/*
+ * The query results hold raw bodies, the ones, that the gc destroys while the results are written out, get skipped
+ */
+static void forget_query_body(b2Body* body) {
+	for (auto & hit : ray_hits) {
+		if (hit.body == body) {
+			hit.body = nullptr;
+		}
+	}
+
+	for (auto & query_body : query_bodies) {
+		if (query_body == body) {
+			query_body = nullptr;
+		}
+	}
+}
+
 void cleanup_body(LitState* state, LitUserdata* data, bool mark) {
+	if (!mark && data == last_data) {
+		last_instance = nullptr;
+		last_data = nullptr;
+	}
+
 	if (!mark && world != nullptr) {
 		b2Body* body = (b2Body*) data->data;
 
 		if (body != nullptr) {
+			contacts.forget((LitInstance*) body->GetUserData().pointer);
+			forget_query_body(body);
+
 			body->GetUserData().pointer = (uintptr_t) nullptr;
 			world->DestroyBody(body);
 		}
@@ -84,8 +168,8 @@ LIT_METHOD(body_constructor) {
 	}
 
 	b2BodyDef def;
-	def.linearDamping = 0.1f;
-	def.angularDamping = 0.1f;
+	def.linearDamping = config.linear_damping;
+	def.angularDamping = config.angular_damping;
 
 	const char* type = AS_CSTRING(args[1]);
 
@@ -104,13 +188,14 @@ LIT_METHOD(body_constructor) {
 	LitUserdata* userdata = lit_create_userdata(vm->state, 0);
 	userdata->cleanup_fn = cleanup_body;
 	userdata->data = body;
-	lit_table_set(vm->state, &AS_INSTANCE(instance)->fields, CONST_STRING(vm->state, "_data"), OBJECT_VALUE(userdata));
+	lit_table_set(vm->state, &AS_INSTANCE(instance)->fields, data_string, OBJECT_VALUE(userdata));
 
 	body->GetUserData().pointer = (uintptr_t) AS_INSTANCE(instance);
 
 	b2FixtureDef fixture;
-	fixture.density = 1;
-	fixture.restitution = 0.6;
+	fixture.density = config.density;
+	fixture.restitution = config.restitution;
+	fixture.friction = config.friction;
 
 	const char* preset = AS_CSTRING(args[0]);
 
@@ -380,6 +465,54 @@ LIT_METHOD(body_velocity_y) {
  * Physics class
  */
 
+static int read_int_option(LitState* state, LitTable* options, const char* name, int value, int min) {
+	LitValue option = lit_get_field(state, options, name);
+
+	if (IS_NUMBER(option)) {
+		value = AS_NUMBER(option);
+	}
+
+	return value < min ? min : value;
+}
+
+static float read_number_option(LitState* state, LitTable* options, const char* name, float value) {
+	LitValue option = lit_get_field(state, options, name);
+	return IS_NUMBER(option) ? AS_NUMBER(option) : value;
+}
+
+static bool read_bool_option(LitState* state, LitTable* options, const char* name, bool value) {
+	LitValue option = lit_get_field(state, options, name);
+	return IS_BOOL(option) ? AS_BOOL(option) : value;
+}
+
+static void read_config(LitState* state, LitTable* options) {
+	config.velocity_iterations = read_int_option(state, options, "velocityIterations", config.velocity_iterations, 1);
+	config.position_iterations = read_int_option(state, options, "positionIterations", config.position_iterations, 1);
+	config.sub_steps = read_int_option(state, options, "subSteps", config.sub_steps, 1);
+
+	config.warm_starting = read_bool_option(state, options, "warmStarting", config.warm_starting);
+	config.continuous = read_bool_option(state, options, "continuous", config.continuous);
+	config.allow_sleep = read_bool_option(state, options, "sleep", config.allow_sleep);
+
+	config.linear_damping = read_number_option(state, options, "linearDamping", config.linear_damping);
+	config.angular_damping = read_number_option(state, options, "angularDamping", config.angular_damping);
+	config.density = read_number_option(state, options, "density", config.density);
+	config.restitution = read_number_option(state, options, "restitution", config.restitution);
+	config.friction = read_number_option(state, options, "friction", config.friction);
+}
+
+static void apply_config() {
+	if (world != nullptr) {
+		world->SetAllowSleeping(config.allow_sleep);
+		world->SetWarmStarting(config.warm_starting);
+		world->SetContinuousPhysics(config.continuous);
+	}
+}
+
+/*
+ * newWorld(gravity x, gravity y, sleep, options)
+ * The options are the same as in configure()
+ */
 LIT_METHOD(physics_new_world) {
 	if (world != nullptr) {
 		return NULL_VALUE;
@@ -387,28 +520,476 @@ LIT_METHOD(physics_new_world) {
 
 	float gravity_x = LIT_GET_NUMBER(0, 0);
 	float gravity_y = LIT_GET_NUMBER(1, -1);
-	bool allow_sleep = LIT_GET_BOOL(2, true);
+
+	if (arg_count > 3 && IS_INSTANCE(args[3])) {
+		read_config(vm->state, &AS_INSTANCE(args[3])->fields);
+	}
+
+	// The positional sleep argument only applies to this world, it doesn't change the config
+	bool allow_sleep = LIT_GET_BOOL(2, config.allow_sleep);
 
 	world = new b2World(b2Vec2(gravity_x, gravity_y));
-	world->SetAllowSleeping(allow_sleep);
 	world->SetDebugDraw(&debug);
+	world->SetContactListener(&contacts);
+	// Forces have to last for all of the sub-steps, they are cleared in update()
+	world->SetAutoClearForces(false);
 
+	apply_config();
+	world->SetAllowSleeping(allow_sleep);
 	debug.SetFlags(b2Draw::e_shapeBit | b2Draw::e_jointBit);
 
 	return NULL_VALUE;
 }
 
+/*
+ * configure(options)
+ * velocityIterations, positionIterations, subSteps, warmStarting, continuous, sleep, and the defaults for new bodies:
+ * linearDamping, angularDamping, density, restitution and friction. Box2D's sleep tolerances are compile time constants,
+ * so sleeping can only be turned on and off
+ */
+LIT_METHOD(physics_configure) {
+	if (arg_count < 1 || !IS_INSTANCE(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected object as argument #1");
+	}
+
+	read_config(vm->state, &AS_INSTANCE(args[0])->fields);
+	apply_config();
+
+	return NULL_VALUE;
+}
+
 LIT_METHOD(physics_destroy_world) {
 	destroy_world(vm->state);
 	return NULL_VALUE;
 }
 
+/*
+ * Calls beginContact(other, normal x, normal y, impulse), endContact(other) and preSolve(other, normal x, normal y)
+ * on both of the bodies, the normal always points away from the body
+ */
+static void dispatch_contact_callbacks(LitState* state) {
+	// The callbacks can collect bodies or step the world again, so the events are rechecked every time
+	for (uint i = 0; i < contacts.events.size(); i++) {
+		ContactEvent event = contacts.events[i];
+
+		if (event.a == nullptr || event.b == nullptr) {
+			continue;
+		}
+
+		LitString* method = contact_methods[event.type];
+		uint arg_count = event.type == CONTACT_BEGIN ? 4 : (event.type == CONTACT_END ? 1 : 3);
+
+		LitValue args[4] = {
+			OBJECT_VALUE(event.b),
+			NUMBER_VALUE(event.normal.x),
+			NUMBER_VALUE(event.normal.y),
+			NUMBER_VALUE(event.impulse)
+		};
+
+		tsab_handle_call(lit_find_and_call_method(state, OBJECT_VALUE(event.a), method, args, arg_count));
+
+		if (i >= contacts.events.size() || contacts.events[i].a != event.a || contacts.events[i].b != event.b) {
+			continue;
+		}
+
+		args[0] = OBJECT_VALUE(event.a);
+		args[1] = NUMBER_VALUE(-event.normal.x);
+		args[2] = NUMBER_VALUE(-event.normal.y);
+
+		tsab_handle_call(lit_find_and_call_method(state, OBJECT_VALUE(event.b), method, args, arg_count));
+	}
+}
+
 LIT_METHOD(physics_update) {
 	if (world != nullptr) {
 		float dt = LIT_GET_NUMBER(0, tsab_get_dt());
-		world->Step(dt, 8, 3);
+
+		contacts.clear();
+
+		tsab_profiler_begin(PROFILER_PHYSICS);
+
+		for (int i = 0; i < config.sub_steps; i++) {
+			world->Step(dt / config.sub_steps, config.velocity_iterations, config.position_iterations);
+		}
+
+		world->ClearForces();
+		tsab_profiler_end(PROFILER_PHYSICS);
+
+		if (contact_callbacks) {
+			dispatch_contact_callbacks(vm->state);
+		}
+	}
+
+	return NULL_VALUE;
+}
+
+/*
+ * Empties the array passed as the argument at the index, or creates a new one
+ */
+static LitArray* reuse_array(LitState* state, uint arg_count, LitValue* args, uint index) {
+	if (arg_count > index && IS_ARRAY(args[index])) {
+		LitArray* array = AS_ARRAY(args[index]);
+		array->values.count = 0;
+
+		return array;
+	}
+
+	return lit_create_array(state);
+}
+
+/*
+ * Makes room for count more values, so that writing them doesn't allocate (and can't run the gc,
+ * which could collect the bodies, that are being written out)
+ */
+static void reserve_array(LitState* state, LitArray* array, uint count) {
+	uint size = array->values.count;
+
+	while (array->values.count < size + count) {
+		lit_values_write(state, &array->values, NULL_VALUE);
+	}
+
+	array->values.count = size;
+}
+
+static void write_hit(LitState* state, LitArray* array, RayHit* hit) {
+	LitValue values[6] = {
+		OBJECT_VALUE((LitInstance*) hit->body->GetUserData().pointer),
+		NUMBER_VALUE(hit->point.x),
+		NUMBER_VALUE(hit->point.y),
+		NUMBER_VALUE(hit->normal.x),
+		NUMBER_VALUE(hit->normal.y),
+		NUMBER_VALUE(hit->fraction)
+	};
+
+	for (int i = 0; i < 6; i++) {
+		lit_values_write(state, &array->values, values[i]);
+	}
+}
+
+/*
+ * Fills the object passed as the argument at the index (or a new one) with body, x, y, normalX, normalY and fraction
+ */
+static LitValue write_hit_object(LitState* state, uint arg_count, LitValue* args, uint index, RayHit* hit) {
+	// Rooting the instance keeps its body alive, while the result gets allocated
+	LitInstance* body = (LitInstance*) hit->body->GetUserData().pointer;
+	lit_push_root(state, (LitObject*) body);
+
+	LitInstance* result;
+
+	if (arg_count > index && IS_INSTANCE(args[index])) {
+		result = AS_INSTANCE(args[index]);
+	} else {
+		result = lit_create_instance(state, state->object_class);
+	}
+
+	lit_push_root(state, (LitObject*) result);
+
+	LitValue values[6] = {
+		OBJECT_VALUE(body),
+		NUMBER_VALUE(hit->point.x),
+		NUMBER_VALUE(hit->point.y),
+		NUMBER_VALUE(hit->normal.x),
+		NUMBER_VALUE(hit->normal.y),
+		NUMBER_VALUE(hit->fraction)
+	};
+
+	for (int i = 0; i < 6; i++) {
+		lit_table_set(state, &result->fields, hit_fields[i], values[i]);
+	}
+
+	lit_pop_roots(state, 2);
+	return OBJECT_VALUE(result);
+}
+
+static LitValue write_bodies(LitState* state, LitArray* array) {
+	lit_push_root(state, (LitObject*) array);
+	reserve_array(state, array, query_bodies.size());
+
+	for (b2Body* body : query_bodies) {
+		if (body != nullptr) {
+			lit_values_write(state, &array->values, OBJECT_VALUE((LitInstance*) body->GetUserData().pointer));
+		}
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(array);
+}
+
+/*
+ * raycast(x1, y1, x2, y2, out)
+ * Returns the closest hit as an object with body, x, y, normalX, normalY and fraction, or null
+ */
+LIT_METHOD(physics_raycast) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	b2Vec2 from(LIT_CHECK_NUMBER(0), LIT_CHECK_NUMBER(1));
+	b2Vec2 to(LIT_CHECK_NUMBER(2), LIT_CHECK_NUMBER(3));
+	RayHit hit;
+
+	if (!tsab_queries_raycast(world, from, to, &hit)) {
+		return NULL_VALUE;
+	}
+
+	return write_hit_object(vm->state, arg_count, args, 4, &hit);
+}
+
+/*
+ * circleCast(x1, y1, x2, y2, radius, out)
+ * Same as raycast, but with a circle swept along the way, x and y are where it touches the body
+ */
+LIT_METHOD(physics_circle_cast) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	b2Vec2 from(LIT_CHECK_NUMBER(0), LIT_CHECK_NUMBER(1));
+	b2Vec2 to(LIT_CHECK_NUMBER(2), LIT_CHECK_NUMBER(3));
+	RayHit hit;
+
+	if (!tsab_queries_circle_cast(world, from, to, LIT_CHECK_NUMBER(4), &hit)) {
+		return NULL_VALUE;
+	}
+
+	return write_hit_object(vm->state, arg_count, args, 5, &hit);
+}
+
+/*
+ * raycastAll(x1, y1, x2, y2, out)
+ * Every hit along the ray from the closest one, flat, 6 values per hit: body, x, y, normal x, normal y and fraction
+ */
+LIT_METHOD(physics_raycast_all) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	b2Vec2 from(LIT_CHECK_NUMBER(0), LIT_CHECK_NUMBER(1));
+	b2Vec2 to(LIT_CHECK_NUMBER(2), LIT_CHECK_NUMBER(3));
+
+	tsab_queries_raycast_all(world, from, to, &ray_hits);
+
+	LitState* state = vm->state;
+	LitArray* result = reuse_array(state, arg_count, args, 4);
+
+	lit_push_root(state, (LitObject*) result);
+	reserve_array(state, result, ray_hits.size() * 6);
+
+	for (auto & hit : ray_hits) {
+		if (hit.body != nullptr) {
+			write_hit(state, result, &hit);
+		}
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+/*
+ * raycastMany(rays, out)
+ * Takes a flat array with x1, y1, x2, y2 per ray and writes 6 values per ray, same as raycastAll,
+ * rays that hit nothing get a null body, their end point and a fraction of 1
+ */
+LIT_METHOD(physics_raycast_many) {
+	if (world == nullptr) {
+		return NULL_VALUE;
 	}
 
+	if (arg_count < 1 || !IS_ARRAY(args[0])) {
+		lit_runtime_error_exiting(vm, "Expected array as argument #1");
+	}
+
+	LitState* state = vm->state;
+	LitValues* rays = &AS_ARRAY(args[0])->values;
+	uint count = rays->count / 4;
+
+	for (uint i = 0; i < count * 4; i++) {
+		if (!IS_NUMBER(rays->values[i])) {
+			lit_runtime_error_exiting(vm, "Expected numbers in the ray array");
+		}
+	}
+
+	LitArray* result = reuse_array(state, arg_count, args, 1);
+
+	// Nothing allocates after this, so the hits can't lose their bodies while they are written out
+	lit_push_root(state, (LitObject*) result);
+	reserve_array(state, result, count * 6);
+
+	for (uint i = 0; i < count * 4; i += 4) {
+		LitValue* ray = rays->values + i;
+		b2Vec2 from(AS_NUMBER(ray[0]), AS_NUMBER(ray[1]));
+		b2Vec2 to(AS_NUMBER(ray[2]), AS_NUMBER(ray[3]));
+		RayHit hit;
+
+		if (tsab_queries_raycast(world, from, to, &hit)) {
+			write_hit(state, result, &hit);
+		} else {
+			LitValue values[6] = { NULL_VALUE, NUMBER_VALUE(to.x), NUMBER_VALUE(to.y), NUMBER_VALUE(0), NUMBER_VALUE(0), NUMBER_VALUE(1) };
+
+			for (int j = 0; j < 6; j++) {
+				lit_values_write(state, &result->values, values[j]);
+			}
+		}
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+/*
+ * queryRect(x, y, w, h, out)
+ * Bodies, that might overlap the rectangle (their bounding boxes do)
+ */
+LIT_METHOD(physics_query_rect) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	float x = LIT_CHECK_NUMBER(0);
+	float y = LIT_CHECK_NUMBER(1);
+	b2AABB aabb;
+
+	aabb.lowerBound = b2Vec2(x, y);
+	aabb.upperBound = b2Vec2(x + LIT_CHECK_NUMBER(2), y + LIT_CHECK_NUMBER(3));
+
+	tsab_queries_query_aabb(world, aabb, &query_bodies);
+	return write_bodies(vm->state, reuse_array(vm->state, arg_count, args, 4));
+}
+
+/*
+ * queryPoint(x, y, out)
+ */
+LIT_METHOD(physics_query_point) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	tsab_queries_query_point(world, b2Vec2(LIT_CHECK_NUMBER(0), LIT_CHECK_NUMBER(1)), &query_bodies);
+	return write_bodies(vm->state, reuse_array(vm->state, arg_count, args, 2));
+}
+
+/*
+ * getTransforms(out, bodies, velocity, awakeOnly)
+ * Positions and angles of the bodies, flat, 3 values per body: x, y and angle (5 with velocity x and y),
+ * the instance for every entry goes into the bodies array, if one is passed. Only awake bodies by default
+ */
+LIT_METHOD(physics_get_transforms) {
+	if (world == nullptr) {
+		return NULL_VALUE;
+	}
+
+	LitState* state = vm->state;
+	LitArray* result = reuse_array(state, arg_count, args, 0);
+	LitArray* bodies = nullptr;
+
+	if (arg_count > 1 && IS_ARRAY(args[1])) {
+		bodies = AS_ARRAY(args[1]);
+		bodies->values.count = 0;
+	}
+
+	bool velocity = LIT_GET_BOOL(2, false);
+	bool awake_only = LIT_GET_BOOL(3, true);
+	uint count = 0;
+
+	for (b2Body* body = world->GetBodyList(); body != nullptr; body = body->GetNext()) {
+		if (body->GetUserData().pointer != 0 && (!awake_only || body->IsAwake())) {
+			count++;
+		}
+	}
+
+	/*
+	 * The gc can destroy bodies while the arrays grow, so they get all of the room up front,
+	 * and nothing allocates while the body list is being walked
+	 */
+	lit_push_root(state, (LitObject*) result);
+	reserve_array(state, result, count * (velocity ? 5 : 3));
+
+	if (bodies != nullptr) {
+		reserve_array(state, bodies, count);
+	}
+
+	for (b2Body* body = world->GetBodyList(); body != nullptr; body = body->GetNext()) {
+		LitInstance* body_instance = (LitInstance*) body->GetUserData().pointer;
+
+		if (body_instance == nullptr || (awake_only && !body->IsAwake())) {
+			continue;
+		}
+
+		b2Vec2 position = body->GetPosition();
+
+		lit_values_write(state, &result->values, NUMBER_VALUE(position.x));
+		lit_values_write(state, &result->values, NUMBER_VALUE(position.y));
+		lit_values_write(state, &result->values, NUMBER_VALUE(body->GetAngle()));
+
+		if (velocity) {
+			b2Vec2 linear_velocity = body->GetLinearVelocity();
+
+			lit_values_write(state, &result->values, NUMBER_VALUE(linear_velocity.x));
+			lit_values_write(state, &result->values, NUMBER_VALUE(linear_velocity.y));
+		}
+
+		if (bodies != nullptr) {
+			lit_values_write(state, &bodies->values, OBJECT_VALUE(body_instance));
+		}
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+/*
+ * getContacts(out)
+ * The contacts of the last update, flat, 8 values per contact: kind, body a, body b, normal x, normal y, x, y and impulse
+ */
+LIT_METHOD(physics_get_contacts) {
+	LitState* state = vm->state;
+	LitArray* result = reuse_array(state, arg_count, args, 0);
+
+	lit_push_root(state, (LitObject*) result);
+	reserve_array(state, result, contacts.events.size() * 8);
+
+	for (uint i = 0; i < contacts.events.size(); i++) {
+		ContactEvent* event = &contacts.events[i];
+
+		if (event->a == nullptr || event->b == nullptr) {
+			continue;
+		}
+
+		LitValue values[8] = {
+			OBJECT_VALUE(contact_kinds[event->type]),
+			OBJECT_VALUE(event->a),
+			OBJECT_VALUE(event->b),
+			NUMBER_VALUE(event->normal.x),
+			NUMBER_VALUE(event->normal.y),
+			NUMBER_VALUE(event->point.x),
+			NUMBER_VALUE(event->point.y),
+			NUMBER_VALUE(event->impulse)
+		};
+
+		for (int j = 0; j < 8; j++) {
+			lit_values_write(state, &result->values, values[j]);
+		}
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+LIT_METHOD(physics_contact_callbacks_get) {
+	return BOOL_VALUE(contact_callbacks);
+}
+
+LIT_METHOD(physics_contact_callbacks_set) {
+	contact_callbacks = LIT_CHECK_BOOL(0);
+	return NULL_VALUE;
+}
+
+LIT_METHOD(physics_report_pre_solve_get) {
+	return BOOL_VALUE(contacts.record_pre_solve);
+}
+
+LIT_METHOD(physics_report_pre_solve_set) {
+	contacts.record_pre_solve = LIT_CHECK_BOOL(0);
 	return NULL_VALUE;
 }
 
@@ -429,8 +1010,8 @@ LIT_METHOD(physics_render) {
 	LitInstance* a = LIT_CHECK_INSTANCE(1);
 	LitInstance* b = LIT_CHECK_INSTANCE(2);
 
-	b2Body* body_a = *extract_body_data_from_instance(vm->state, a);
-	b2Body* body_b = *extract_body_data_from_instance(vm->state, b);
+	b2Body* body_a = *extract_body_data_from_instance(a);
+	b2Body* body_b = *extract_body_data_from_instance(b);
 
 	b2DistanceJointDef def;
 
@@ -450,6 +1031,27 @@ LIT_METHOD(physics_render) {
 }*/
 
 void tsab_physics_bind_api(LitState* state) {
+	const char* kinds[3] = { "begin", "end", "preSolve" };
+	const char* methods[3] = { "beginContact", "endContact", "preSolve" };
+
+	for (int i = 0; i < 3; i++) {
+		contact_kinds[i] = CONST_STRING(state, kinds[i]);
+		tsab_keep_alive((LitObject*) contact_kinds[i]);
+
+		contact_methods[i] = CONST_STRING(state, methods[i]);
+		tsab_keep_alive((LitObject*) contact_methods[i]);
+	}
+
+	data_string = CONST_STRING(state, "_data");
+	tsab_keep_alive((LitObject*) data_string);
+
+	const char* fields[6] = { "body", "x", "y", "normalX", "normalY", "fraction" };
+
+	for (int i = 0; i < 6; i++) {
+		hit_fields[i] = CONST_STRING(state, fields[i]);
+		tsab_keep_alive((LitObject*) hit_fields[i]);
+	}
+
 	LIT_BEGIN_CLASS("Body")
 		LIT_BIND_CONSTRUCTOR(body_constructor)
 
@@ -475,8 +1077,20 @@ void tsab_physics_bind_api(LitState* state) {
 	LIT_BEGIN_CLASS("Physics")
 		LIT_BIND_STATIC_METHOD("newWorld", physics_new_world)
 		LIT_BIND_STATIC_METHOD("destroyWorld", physics_destroy_world)
+		LIT_BIND_STATIC_METHOD("configure", physics_configure)
 		LIT_BIND_STATIC_METHOD("update", physics_update)
 		LIT_BIND_STATIC_METHOD("render", physics_render)
+		LIT_BIND_STATIC_METHOD("getContacts", physics_get_contacts)
+		LIT_BIND_STATIC_METHOD("getTransforms", physics_get_transforms)
+		LIT_BIND_STATIC_METHOD("raycast", physics_raycast)
+		LIT_BIND_STATIC_METHOD("raycastAll", physics_raycast_all)
+		LIT_BIND_STATIC_METHOD("raycastMany", physics_raycast_many)
+		LIT_BIND_STATIC_METHOD("circleCast", physics_circle_cast)
+		LIT_BIND_STATIC_METHOD("queryRect", physics_query_rect)
+		LIT_BIND_STATIC_METHOD("queryPoint", physics_query_point)
 		// LIT_BIND_STATIC_METHOD("join", physics_join)
+
+		LIT_BIND_STATIC_FIELD("contactCallbacks", physics_contact_callbacks_get, physics_contact_callbacks_set)
+		LIT_BIND_STATIC_FIELD("reportPreSolve", physics_report_pre_solve_get, physics_report_pre_solve_set)
 	LIT_END_CLASS()
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include <tsab/physics/tsab_queries.hpp>
+
+#include <algorithm>
+
+// Reused by the circle casts
+static std::vector<b2Fixture*> cast_fixtures;
+
+static bool should_skip(b2Fixture* fixture) {
+	return fixture->IsSensor() || fixture->GetBody()->GetUserData().pointer == 0;
+}
+
+float ClosestRayCallback::ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) {
+	if (should_skip(fixture)) {
+		return -1;
+	}
+
+	hit = { fixture->GetBody(), point, normal, fraction };
+	found = true;
+
+	// Clips the ray, so that only closer fixtures get reported from now on
+	return fraction;
+}
+
+float AllRayCallback::ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) {
+	if (should_skip(fixture)) {
+		return -1;
+	}
+
+	hits->push_back({ fixture->GetBody(), point, normal, fraction });
+	return 1;
+}
+
+bool FixtureQueryCallback::ReportFixture(b2Fixture* fixture) {
+	if (!should_skip(fixture)) {
+		fixtures->push_back(fixture);
+	}
+
+	return true;
+}
+
+bool BodyQueryCallback::ReportFixture(b2Fixture* fixture) {
+	if (should_skip(fixture) || (test_point && !fixture->TestPoint(point))) {
+		return true;
+	}
+
+	b2Body* body = fixture->GetBody();
+
+	// Bodies with several fixtures are reported once
+	if (std::find(bodies->begin(), bodies->end(), body) == bodies->end()) {
+		bodies->push_back(body);
+	}
+
+	return true;
+}
+
+static bool is_valid_ray(b2Vec2 from, b2Vec2 to) {
+	// Box2D asserts on zero length rays
+	return from.x != to.x || from.y != to.y;
+}
+
+bool tsab_queries_raycast(b2World* world, b2Vec2 from, b2Vec2 to, RayHit* hit) {
+	if (!is_valid_ray(from, to)) {
+		return false;
+	}
+
+	ClosestRayCallback callback;
+	world->RayCast(&callback, from, to);
+
+	if (callback.found) {
+		*hit = callback.hit;
+	}
+
+	return callback.found;
+}
+
+void tsab_queries_raycast_all(b2World* world, b2Vec2 from, b2Vec2 to, std::vector<RayHit>* hits) {
+	hits->clear();
+
+	if (!is_valid_ray(from, to)) {
+		return;
+	}
+
+	AllRayCallback callback;
+	callback.hits = hits;
+
+	world->RayCast(&callback, from, to);
+
+	std::sort(hits->begin(), hits->end(), [](const RayHit& a, const RayHit& b) {
+		return a.fraction < b.fraction;
+	});
+}
+
+/*
+ * Box2D has no world wide shape cast, so the fixtures, that the swept circle might touch, are gathered with an AABB query
+ * and then cast against one by one
+ */
+bool tsab_queries_circle_cast(b2World* world, b2Vec2 from, b2Vec2 to, float radius, RayHit* hit) {
+	if (!is_valid_ray(from, to) || radius <= 0) {
+		return false;
+	}
+
+	FixtureQueryCallback callback;
+	b2AABB aabb;
+
+	cast_fixtures.clear();
+	callback.fixtures = &cast_fixtures;
+
+	aabb.lowerBound = b2Min(from, to) - b2Vec2(radius, radius);
+	aabb.upperBound = b2Max(from, to) + b2Vec2(radius, radius);
+
+	world->QueryAABB(&callback, aabb);
+
+	b2CircleShape circle;
+	circle.m_radius = radius;
+	circle.m_p.Set(0, 0);
+
+	b2ShapeCastInput input;
+
+	input.proxyB.Set(&circle, 0);
+	input.transformB.Set(from, 0);
+	input.translationB = to - from;
+
+	bool found = false;
+
+	for (b2Fixture* fixture : cast_fixtures) {
+		b2Shape* shape = fixture->GetShape();
+
+		input.transformA = fixture->GetBody()->GetTransform();
+
+		for (int i = 0; i < shape->GetChildCount(); i++) {
+			b2ShapeCastOutput output;
+			input.proxyA.Set(shape, i);
+
+			if (b2ShapeCast(&output, &input) && (!found || output.lambda < hit->fraction)) {
+				// Same as with the rays, the normal faces the caster
+				if (b2Dot(output.normal, input.translationB) > 0) {
+					output.normal = -output.normal;
+				}
+
+				*hit = { fixture->GetBody(), output.point, output.normal, output.lambda };
+				found = true;
+			}
+		}
+	}
+
+	return found;
+}
+
+void tsab_queries_query_aabb(b2World* world, b2AABB aabb, std::vector<b2Body*>* bodies) {
+	BodyQueryCallback callback;
+
+	bodies->clear();
+	callback.bodies = bodies;
+
+	world->QueryAABB(&callback, aabb);
+}
+
+void tsab_queries_query_point(b2World* world, b2Vec2 point, std::vector<b2Body*>* bodies) {
+	BodyQueryCallback callback;
+
+	bodies->clear();
+	callback.bodies = bodies;
+	callback.test_point = true;
+	callback.point = point;
+
+	b2AABB aabb;
+
+	aabb.lowerBound = point - b2Vec2(0.001f, 0.001f);
+	aabb.upperBound = point + b2Vec2(0.001f, 0.001f);
+
+	world->QueryAABB(&callback, aabb);
+}
\ No newline at end of file
@@ -1,10 +1,13 @@
 #include <tsab/tsab.hpp>
 #include <tsab/tsab_common.hpp>
 #include <tsab/graphics/tsab_graphics.hpp>
+#include <tsab/graphics/tsab_loader.hpp>
 #include <tsab/tsab_shaders.hpp>
 #include <tsab/tsab_audio.hpp>
 #include <tsab/tsab_input.hpp>
 #include <tsab/tsab_ui.hpp>
+#include <tsab/tsab_profiler.hpp>
+#include <tsab/tsab_timer.hpp>
 #include <tsab/physics/tsab_physics.hpp>
 
 #include "lit.hpp"
@@ -14,6 +17,7 @@
 #include <SDL_image.h>
 
 #include <cstring>
+#include <cmath>
 #include <iostream>
 
 static bool tsab_inited;
@@ -22,16 +26,24 @@ static SDL_Event event;
 
 static LitInstance* tsab = nullptr;
 static LitString* update_string = nullptr;
+static LitString* fixed_update_string = nullptr;
 static LitString* render_string = nullptr;
 
-static int start_time;
-static int end_time;
-static float delta;
-static float time_per_frame = 1000.0f / 60;
-static float fps;
+// Objects, that native code keeps pointers to, see tsab_keep_alive()
+static LitArray* kept_alive = nullptr;
+
 static LitValue last_error = NULL_VALUE;
+static bool had_error = false;
+
+// Fixed timestep mode, enabled with loop.fixed_rate in the config
+static bool fixed_timestep = false;
+static bool in_fixed_update = false;
+static float fixed_dt = 1.0f / 60;
+static int max_fixed_steps = 5;
+static float accumulator = 0;
 
 static LitInstance* configure();
+static void configure_loop(LitInstance* config);
 
 extern "C" const char prefix[];
 
@@ -58,6 +70,7 @@ bool tsab_handle_call(LitInterpretResult result) {
 
 	call_tsab_method(CONST_STRING(state, "handleError"), &last_error, 1);
 	last_error = NULL_VALUE;
+	had_error = true;
 
 	return true;
 }
@@ -66,10 +79,20 @@ void tsab_call_method(const char* name, LitValue* args, uint arg_count) {
 	tsab_handle_call(call_tsab_method(CONST_STRING(state, name), args, arg_count));
 }
 
-bool tsab_init(bool debug) {
+void tsab_call_method(LitString* name, LitValue* args, uint arg_count) {
+	tsab_handle_call(call_tsab_method(name, args, arg_count));
+}
+
+void tsab_keep_alive(LitObject* object) {
+	lit_push_root(state, object);
+	lit_values_write(state, &kept_alive->values, OBJECT_VALUE(object));
+	lit_pop_root(state);
+}
+
+bool tsab_init(bool debug, bool headless) {
 	tsab_inited = true;
 
-	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+	if (SDL_Init(headless ? SDL_INIT_TIMER | SDL_INIT_EVENTS : SDL_INIT_EVERYTHING) != 0) {
 		tsab_report_sdl_error();
 		return false;
 	}
@@ -77,6 +100,10 @@ bool tsab_init(bool debug) {
 	state = lit_new_state();
 	state->error_fn = error_callback;
 
+	// Stays at the bottom of the root stack, everything above it gets pushed and popped in pairs
+	kept_alive = lit_create_array(state);
+	lit_push_root(state, (LitObject*) kept_alive);
+
 	lit_open_libraries(state);
 	lit_add_definition(state, debug ? "DEBUG" : "RELEASE");
 	lit_set_optimization_level(debug ? OPTIMIZATION_LEVEL_DEBUG : OPTIMIZATION_LEVEL_RELEASE);
@@ -92,13 +119,23 @@ bool tsab_init(bool debug) {
 	tsab = AS_INSTANCE(value);
 	LitInstance* config = configure();
 
-	if (!tsab_graphics_init(state, config)) {
+	configure_loop(config);
+	tsab_timer_configure(state, config);
+
+	if (!tsab_graphics_init(state, config, headless)) {
 		tsab_report_sdl_error();
 		return false;
 	}
 
-	tsab_ui_init();
-	tsab_audio_init();
+	if (headless) {
+		// Nothing to sync to, run as fast as we can unless asked otherwise
+		tsab_timer_set_vsync(VSYNC_OFF);
+		tsab_timer_set_fps(0);
+	} else {
+		tsab_ui_init();
+		tsab_audio_init();
+	}
+
 	tsab_input_init();
 
 	TTF_Init();
@@ -110,6 +147,8 @@ bool tsab_init(bool debug) {
 	tsab_audio_bind_api(state);
 	tsab_physics_bind_api(state);
 	tsab_ui_bind_api(state);
+	tsab_profiler_bind_api(state);
+	tsab_timer_bind_api(state);
 
 	LitInterpretResult result;
 
@@ -131,6 +170,7 @@ bool tsab_init(bool debug) {
 	}
 
 	update_string = CONST_STRING(state, "update");
+	fixed_update_string = CONST_STRING(state, "fixedUpdate");
 	render_string = CONST_STRING(state, "render");
 
 	tsab_graphics_get_ready();
@@ -143,10 +183,12 @@ void tsab_quit() {
 	}
 
 	tsab_inited = false;
+	tsab_loader_quit();
 
 	if (state != nullptr) {
 		call_tsab_method(CONST_STRING(state, "destroy"), nullptr, 0);
 		lit_free_state(state);
+		kept_alive = nullptr;
 	}
 
 	tsab_physics_quit(state);
@@ -161,8 +203,36 @@ void tsab_quit() {
 	SDL_Quit();
 }
 
+/*
+ * Runs fixedUpdate as many times as the accumulated time asks for and returns the interpolation alpha for render
+ */
+static float run_fixed_updates(float dt) {
+	accumulator += dt;
+	int steps = 0;
+
+	LitValue step = NUMBER_VALUE(fixed_dt);
+	in_fixed_update = true;
+
+	while (accumulator >= fixed_dt && steps < max_fixed_steps) {
+		tsab_handle_call(call_tsab_method(fixed_update_string, &step, 1));
+
+		accumulator -= fixed_dt;
+		steps++;
+	}
+
+	in_fixed_update = false;
+
+	// Can't keep up, drop the time we are behind instead of falling further back every frame
+	if (accumulator >= fixed_dt) {
+		accumulator = fmod(accumulator, fixed_dt);
+	}
+
+	return accumulator / fixed_dt;
+}
+
 bool tsab_frame() {
-	start_time = SDL_GetTicks();
+	tsab_profiler_begin_frame();
+	tsab_profiler_begin(PROFILER_EVENTS);
 
 	while (SDL_PollEvent(&event)) {
 		switch (event.type) {
@@ -175,7 +245,17 @@ bool tsab_frame() {
 		tsab_graphics_handle_event(&event);
 	}
 
-	float realDelta = delta / 1000.0f;
+	tsab_input_update();
+
+	tsab_profiler_end(PROFILER_EVENTS);
+	tsab_profiler_begin(PROFILER_LOADER);
+
+	tsab_loader_update(state);
+
+	tsab_profiler_end(PROFILER_LOADER);
+	tsab_profiler_begin(PROFILER_UPDATE);
+
+	float realDelta = tsab_timer_get_delta();
 	LitValue dt = NUMBER_VALUE(realDelta);
 	LitInterpretResult interpret_result = call_tsab_method(update_string, &dt, 1);
 
@@ -184,30 +264,36 @@ bool tsab_frame() {
 	}
 
 	tsab_handle_call(interpret_result);
+	LitValue alpha = NULL_VALUE;
+
+	if (fixed_timestep) {
+		alpha = NUMBER_VALUE(run_fixed_updates(realDelta));
+	}
+
+	tsab_profiler_end(PROFILER_UPDATE);
+	tsab_profiler_begin(PROFILER_RENDER);
 
-	tsab_input_update();
 	tsab_graphics_begin_frame(realDelta);
+	tsab_handle_call(call_tsab_method(render_string, &alpha, fixed_timestep ? 1 : 0));
 
-	tsab_handle_call(call_tsab_method(render_string, nullptr, 0));
-	tsab_graphics_finish_frame();
+	tsab_profiler_end(PROFILER_RENDER);
+	tsab_profiler_begin(PROFILER_FLIP);
 
-	delta = (float) end_time - (float) start_time;
+	tsab_graphics_finish_frame();
 
-	if (delta < time_per_frame) {
-		SDL_Delay(time_per_frame - delta);
-		delta = time_per_frame;
-	}
+	tsab_profiler_end(PROFILER_FLIP);
+	tsab_profiler_begin(PROFILER_SLEEP);
 
-	fps = 1000.0f / delta;
+	tsab_timer_wait();
 
-	start_time = end_time;
-	end_time = SDL_GetTicks();
+	tsab_profiler_end(PROFILER_SLEEP);
+	tsab_profiler_end_frame();
 
 	return false;
 }
 
 void tsab_setup_loop() {
-	end_time = SDL_GetTicks();
+	tsab_timer_start();
 }
 
 void tsab_loop() {
@@ -244,14 +330,50 @@ static LitInstance* configure() {
 	return nullptr;
 }
 
+static void configure_loop(LitInstance* config) {
+	if (config == nullptr) {
+		return;
+	}
+
+	LitValue l = lit_get_field(state, &config->fields, "loop");
+
+	if (!IS_INSTANCE(l)) {
+		return;
+	}
+
+	LitTable* loop_map = &AS_INSTANCE(l)->fields;
+	LitValue value;
+
+	if (IS_NUMBER(value = lit_get_field(state, loop_map, "fixed_rate")) && AS_NUMBER(value) > 0) {
+		fixed_timestep = true;
+		fixed_dt = 1.0f / AS_NUMBER(value);
+	}
+
+	if (IS_NUMBER(value = lit_get_field(state, loop_map, "max_steps"))) {
+		max_fixed_steps = fmax(1, AS_NUMBER(value));
+	}
+}
+
 float tsab_get_dt() {
-	return delta / 1000.0f;
+	if (in_fixed_update) {
+		return fixed_dt;
+	}
+
+	return tsab_timer_get_delta();
 }
 
 LitState* tsab_get_state() {
 	return state;
 }
 
+LitInstance* tsab_get_instance() {
+	return tsab;
+}
+
+bool tsab_had_error() {
+	return had_error;
+}
+
 void tsab_error(const char* message) {
 	std::cerr << message << std::endl;
 }
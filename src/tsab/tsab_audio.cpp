@@ -14,15 +14,22 @@
 static std::vector<Mix_Chunk*> loaded_sounds;
 static std::map<std::string, int> sound_ids;
 static std::map<std::string, Mix_Music*> loaded_music;
+static bool opened = false;
 
 void tsab_audio_init() {
 	if (Mix_OpenAudio(22050, MIX_DEFAULT_FORMAT, 2, 1024) == -1) {
 		tsab_report_sdl_error_non_fatal();
 		return;
 	}
+
+	opened = true;
 }
 
 void tsab_audio_quit() {
+	if (!opened) {
+		return;
+	}
+
 	for (Mix_Chunk* sound : loaded_sounds) {
 		Mix_FreeChunk(sound);
 	}
@@ -128,11 +135,20 @@ LIT_METHOD(audio_play) {
 	return NULL_VALUE;
 }
 
+LIT_METHOD(audio_noop) {
+	return NULL_VALUE;
+}
+
 void tsab_audio_bind_api(LitState* state) {
+	// Headless runs (or machines without an audio device) don't load or play anything
+	#define AUDIO_METHOD(method) (opened ? method : audio_noop)
+
 	LIT_BEGIN_CLASS("Audio")
-		LIT_BIND_STATIC_METHOD("newSound", audio_new_sound)
-		LIT_BIND_STATIC_METHOD("fadeIn", audio_fade_in)
-		LIT_BIND_STATIC_METHOD("fadeOut", audio_fade_out)
-		LIT_BIND_STATIC_METHOD("play", audio_play)
+		LIT_BIND_STATIC_METHOD("newSound", AUDIO_METHOD(audio_new_sound))
+		LIT_BIND_STATIC_METHOD("fadeIn", AUDIO_METHOD(audio_fade_in))
+		LIT_BIND_STATIC_METHOD("fadeOut", AUDIO_METHOD(audio_fade_out))
+		LIT_BIND_STATIC_METHOD("play", AUDIO_METHOD(audio_play))
 	LIT_END_CLASS()
+
+	#undef AUDIO_METHOD
 }
\ No newline at end of file
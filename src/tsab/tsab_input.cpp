@@ -2,32 +2,90 @@
 
 #include <SDL.h>
 
-#include <map>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include <cstring>
+#include <cmath>
 #include <iostream>
 #include <tsab/tsab.hpp>
 
-static Uint8 *input_previous_gamepad_button_state = nullptr;
-static Uint8 *input_current_gamepad_button_state = nullptr;
-static Sint16 *input_gamepad_axis_state = nullptr;
 static Uint8 *input_previous_mouse_state = nullptr;
 static Uint8 *input_current_mouse_state = nullptr;
+static Uint8 *input_mouse_events = nullptr;
+static Uint8 *input_mouse_held = nullptr;
 static Uint8 *input_previous_keyboard_state = nullptr;
-static SDL_GameController *controller = nullptr;
-static const Uint8 *input_current_keyboard_state = nullptr;
+static Uint8 *input_current_keyboard_state = nullptr;
+static ControllerSlot controllers[INPUT_MAX_CONTROLLERS];
 
 extern "C" const char gamecontrollerdb[];
 extern "C" const size_t gamecontrollerdb_len;
 
-static std::map<std::string, int> key_map;
-static std::map<int, std::string> key_names;
+static std::vector<InputKey> keys;
+static std::vector<const char*> key_list;
+static std::unordered_map<LitString*, int> key_handles;
+// Indexed by the key handles, the strings are handed to keyPressed and keyReleased as they are.
+// All of the strings and arrays here are kept alive with tsab_keep_alive()
+static std::vector<LitString*> key_names;
+
+static LitString* key_pressed_string = nullptr;
+static LitString* key_released_string = nullptr;
+static LitString* controller_connected_string = nullptr;
+static LitString* controller_disconnected_string = nullptr;
+
+// With Input.batchKeyEvents, the key callbacks get called once per frame with all of the keys
+static bool batch_key_events = false;
+static LitArray* pressed_keys = nullptr;
+static LitArray* released_keys = nullptr;
+
+// Reverse lookups for the event buffer
+static int keyboard_handles[512];
+static int mouse_handles[12];
+static int controller_handles[SDL_CONTROLLER_BUTTON_MAX];
+
+static InputEvent event_buffer[INPUT_EVENT_BUFFER_SIZE];
+// Both only ever grow, the buffer index is the count modulo the buffer size
+static uint64_t event_count;
+static uint64_t event_read;
+
+#define ACTION_WORDS (INPUT_MAX_ACTIONS / 64)
+
+static std::vector<InputAction> actions;
+static std::unordered_map<LitString*, int> action_handles;
+// Indexed by the action handles, the names are kept alive with tsab_keep_alive()
+static std::vector<LitString*> action_names;
+
+static uint64_t actions_current[ACTION_WORDS];
+static uint64_t actions_previous[ACTION_WORDS];
+
+static inline bool test_bit(const uint64_t* set, int bit) {
+	return (set[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static void register_input(const char* name, InputDevice device, int code) {
+	int handle = keys.size();
+
+	keys.push_back({ device, code });
+	key_list.push_back(name);
+
+	if (device == INPUT_KEYBOARD) {
+		keyboard_handles[code] = handle;
+	} else if (device == INPUT_MOUSE) {
+		mouse_handles[code] = handle;
+	} else if (device == INPUT_CONTROLLER) {
+		controller_handles[code] = handle;
+	}
+}
 
-static void register_key(std::string key, SDL_Scancode code) {
-	key_map[key] = code;
-	key_names[code] = key;
+static void register_key(const char* key, SDL_Scancode code) {
+	register_input(key, INPUT_KEYBOARD, code);
 }
 
 static void setup_key_map() {
+	std::fill(keyboard_handles, keyboard_handles + 512, -1);
+	std::fill(mouse_handles, mouse_handles + 12, -1);
+	std::fill(controller_handles, controller_handles + SDL_CONTROLLER_BUTTON_MAX, -1);
+
 	register_key("a", SDL_SCANCODE_A);
 	register_key("b", SDL_SCANCODE_B);
 	register_key("c", SDL_SCANCODE_C);
@@ -79,8 +137,8 @@ static void setup_key_map() {
 	register_key("space", SDL_SCANCODE_SPACE);
 	register_key("lshift", SDL_SCANCODE_LSHIFT);
 	register_key("rshift", SDL_SCANCODE_RSHIFT);
-	register_key("rcontrol", SDL_SCANCODE_LCTRL);
-	register_key("lcontrol", SDL_SCANCODE_RCTRL);
+	register_key("lcontrol", SDL_SCANCODE_LCTRL);
+	register_key("rcontrol", SDL_SCANCODE_RCTRL);
 	register_key("lalt", SDL_SCANCODE_LALT);
 	register_key("ralt", SDL_SCANCODE_RALT);
 	register_key("capslock", SDL_SCANCODE_CAPSLOCK);
@@ -100,181 +158,522 @@ static void setup_key_map() {
 	register_key("down", SDL_SCANCODE_DOWN);
 	register_key("comma", SDL_SCANCODE_COMMA);
 
-	key_map["mouse1"] = MOUSE_1;
-	key_map["mouse2"] = MOUSE_2;
-	key_map["mouse3"] = MOUSE_3;
-	key_map["mouse4"] = MOUSE_4;
-	key_map["mouse5"] = MOUSE_5;
-	key_map["mouse_wheel_up"] = MOUSE_WHEEL_UP;
-	key_map["mouse_wheel_down"] = MOUSE_WHEEL_DOWN;
-	key_map["mouse_wheel_left"] = MOUSE_WHEEL_LEFT;
-	key_map["mouse_wheel_right"] = MOUSE_WHEEL_RIGHT;
-
-	key_map["controller_x"] = SDL_CONTROLLER_BUTTON_X;
-	key_map["controller_y"] = SDL_CONTROLLER_BUTTON_Y;
-	key_map["controller_a"] = SDL_CONTROLLER_BUTTON_A;
-	key_map["controller_b"] = SDL_CONTROLLER_BUTTON_B;
-	key_map["controller_back"] = SDL_CONTROLLER_BUTTON_BACK;
-	key_map["controller_start"] = SDL_CONTROLLER_BUTTON_START;
-	key_map["controller_dpad_up"] = SDL_CONTROLLER_BUTTON_DPAD_UP;
-	key_map["controller_dpad_down"] = SDL_CONTROLLER_BUTTON_DPAD_DOWN;
-	key_map["controller_dpad_left"] = SDL_CONTROLLER_BUTTON_DPAD_LEFT;
-	key_map["controller_dpad_right"] = SDL_CONTROLLER_BUTTON_DPAD_RIGHT;
-	key_map["controller_lstick_button"] = SDL_CONTROLLER_BUTTON_LEFTSTICK;
-	key_map["controller_rstick_button"] = SDL_CONTROLLER_BUTTON_LEFTSTICK;
-	key_map["controller_lshoulder"] = SDL_CONTROLLER_BUTTON_LEFTSHOULDER;
-	key_map["controller_rshoulder"] = SDL_CONTROLLER_BUTTON_RIGHTSHOULDER;
-
-	key_map["lx"] = SDL_CONTROLLER_AXIS_LEFTX;
-	key_map["ry"] = SDL_CONTROLLER_AXIS_LEFTY;
-	key_map["lx"] = SDL_CONTROLLER_AXIS_RIGHTX;
-	key_map["ry"] = SDL_CONTROLLER_AXIS_RIGHTY;
-	key_map["ltrigger"] = SDL_CONTROLLER_AXIS_TRIGGERLEFT;
-	key_map["rtrigger"] = SDL_CONTROLLER_AXIS_TRIGGERRIGHT;
+	register_input("mouse1", INPUT_MOUSE, MOUSE_1);
+	register_input("mouse2", INPUT_MOUSE, MOUSE_2);
+	register_input("mouse3", INPUT_MOUSE, MOUSE_3);
+	register_input("mouse4", INPUT_MOUSE, MOUSE_4);
+	register_input("mouse5", INPUT_MOUSE, MOUSE_5);
+	register_input("mouse_wheel_up", INPUT_MOUSE, MOUSE_WHEEL_UP);
+	register_input("mouse_wheel_down", INPUT_MOUSE, MOUSE_WHEEL_DOWN);
+	register_input("mouse_wheel_left", INPUT_MOUSE, MOUSE_WHEEL_LEFT);
+	register_input("mouse_wheel_right", INPUT_MOUSE, MOUSE_WHEEL_RIGHT);
+
+	register_input("controller_x", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_X);
+	register_input("controller_y", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_Y);
+	register_input("controller_a", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_A);
+	register_input("controller_b", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_B);
+	register_input("controller_back", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_BACK);
+	register_input("controller_start", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_START);
+	register_input("controller_dpad_up", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_DPAD_UP);
+	register_input("controller_dpad_down", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_DPAD_DOWN);
+	register_input("controller_dpad_left", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_DPAD_LEFT);
+	register_input("controller_dpad_right", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_DPAD_RIGHT);
+	register_input("controller_lstick_button", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_LEFTSTICK);
+	register_input("controller_rstick_button", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_RIGHTSTICK);
+	register_input("controller_lshoulder", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_LEFTSHOULDER);
+	register_input("controller_rshoulder", INPUT_CONTROLLER, SDL_CONTROLLER_BUTTON_RIGHTSHOULDER);
+
+	register_input("lx", INPUT_AXIS, SDL_CONTROLLER_AXIS_LEFTX);
+	register_input("ly", INPUT_AXIS, SDL_CONTROLLER_AXIS_LEFTY);
+	register_input("rx", INPUT_AXIS, SDL_CONTROLLER_AXIS_RIGHTX);
+	register_input("ry", INPUT_AXIS, SDL_CONTROLLER_AXIS_RIGHTY);
+	register_input("ltrigger", INPUT_AXIS, SDL_CONTROLLER_AXIS_TRIGGERLEFT);
+	register_input("rtrigger", INPUT_AXIS, SDL_CONTROLLER_AXIS_TRIGGERRIGHT);
 }
 
 void tsab_input_init() {
 	setup_key_map();
 	SDL_GameControllerAddMappingsFromRW(SDL_RWFromMem((void *) gamecontrollerdb, gamecontrollerdb_len), 1);
 
-	input_previous_keyboard_state = new Uint8[512];
-	input_current_keyboard_state = SDL_GetKeyboardState(nullptr);
-
-	input_previous_mouse_state = new Uint8[12];
-	input_current_mouse_state = new Uint8[12];
+	input_previous_keyboard_state = new Uint8[512]();
+	input_current_keyboard_state = new Uint8[512]();
 
-	input_previous_gamepad_button_state = new Uint8[SDL_CONTROLLER_BUTTON_MAX - SDL_CONTROLLER_BUTTON_INVALID + 1];
-	input_current_gamepad_button_state = new Uint8[SDL_CONTROLLER_BUTTON_MAX - SDL_CONTROLLER_BUTTON_INVALID + 1];
-	input_gamepad_axis_state = new Sint16[SDL_CONTROLLER_AXIS_MAX - SDL_CONTROLLER_AXIS_INVALID + 1];
+	input_previous_mouse_state = new Uint8[12]();
+	input_current_mouse_state = new Uint8[12]();
+	input_mouse_events = new Uint8[12]();
+	input_mouse_held = new Uint8[12]();
 }
 
 void tsab_input_quit() {
-	if (input_previous_mouse_state != nullptr) {
-		delete input_previous_mouse_state;
+	delete[] input_previous_mouse_state;
+	input_previous_mouse_state = nullptr;
+
+	delete[] input_current_mouse_state;
+	input_current_mouse_state = nullptr;
+
+	delete[] input_mouse_events;
+	input_mouse_events = nullptr;
+
+	delete[] input_mouse_held;
+	input_mouse_held = nullptr;
+
+	delete[] input_previous_keyboard_state;
+	input_previous_keyboard_state = nullptr;
+
+	delete[] input_current_keyboard_state;
+	input_current_keyboard_state = nullptr;
+
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		if (controllers[i].controller != nullptr) {
+			SDL_GameControllerClose(controllers[i].controller);
+			controllers[i].controller = nullptr;
+		}
 	}
+}
 
-	if (input_current_mouse_state != nullptr) {
-		delete input_current_mouse_state;
+typedef enum {
+	KEY_DOWN,
+	KEY_PRESSED,
+	KEY_RELEASED
+} KeyQuery;
+
+static bool test_key_state(bool current, bool previous, KeyQuery query) {
+	if (query == KEY_PRESSED) {
+		return current && !previous;
+	} else if (query == KEY_RELEASED) {
+		return !current && previous;
 	}
 
-	if (input_previous_gamepad_button_state != nullptr) {
-		delete input_previous_keyboard_state;
+	return current;
+}
+
+/*
+ * Without a player any controller counts. Presses and releases are checked per controller,
+ * so that one holding the button down doesn't hide a press on another
+ */
+static bool test_key(InputKey* key, int player, KeyQuery query) {
+	int code = key->code;
+
+	switch (key->device) {
+		case INPUT_KEYBOARD: {
+			return test_key_state(input_current_keyboard_state[code] == 1, input_previous_keyboard_state[code] == 1, query);
+		}
+
+		case INPUT_MOUSE: {
+			return test_key_state(input_current_mouse_state[code] == 1, input_previous_mouse_state[code] == 1, query);
+		}
+
+		case INPUT_CONTROLLER: {
+			for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+				ControllerSlot* slot = &controllers[i];
+
+				if (slot->controller == nullptr || (player >= 0 && player != i)) {
+					continue;
+				}
+
+				if (test_key_state(slot->current.buttons[code] == 1, slot->previous.buttons[code] == 1, query)) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		default: {
+			return false;
+		}
 	}
 }
 
-void tsab_input_update() {
-	for (int i = 0; i < 512; i++) {
-		input_previous_keyboard_state[i] = input_current_keyboard_state[i];
+/*
+ * Without a player, the controller that pushes the axis the furthest wins
+ */
+static float get_axis_value(int axis, int player, bool* connected) {
+	float value = 0;
+	*connected = false;
+
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		ControllerSlot* slot = &controllers[i];
+
+		if (slot->controller == nullptr || (player >= 0 && player != i)) {
+			continue;
+		}
+
+		float slot_value = std::max<float>(-1, slot->current.axes[axis] / 32767.0f);
+		*connected = true;
+
+		if (fabs(slot_value) > fabs(value)) {
+			value = slot_value;
+		}
 	}
 
+	return value;
+}
+
+static float get_binding_value(ActionBinding* binding, int player) {
+	if (binding->key.device == INPUT_AXIS) {
+		bool connected;
+		float value = get_axis_value(binding->key.code, player, &connected);
+
+		return binding->direction == 0 ? value : std::max<float>(0, value * binding->direction);
+	}
+
+	return test_key(&binding->key, player, KEY_DOWN) ? 1 : 0;
+}
+
+static void update_actions() {
+	memcpy(actions_previous, actions_current, sizeof(actions_current));
+	memset(actions_current, 0, sizeof(actions_current));
+
+	for (uint i = 0; i < actions.size(); i++) {
+		InputAction* action = &actions[i];
+		float value = 0;
+
+		// The strongest binding wins
+		for (auto & binding : action->bindings) {
+			float binding_value = get_binding_value(&binding, action->player);
+
+			if (fabs(binding_value) > fabs(value)) {
+				value = binding_value;
+			}
+		}
+
+		if (fabs(value) <= action->deadzone) {
+			value = 0;
+		} else {
+			actions_current[i >> 6] |= (uint64_t) 1 << (i & 63);
+		}
+
+		action->value = value;
+	}
+}
+
+static void send_key_event(SDL_Scancode scancode, LitArray* batch, LitString* method) {
+	int handle = scancode < 512 ? keyboard_handles[scancode] : -1;
+
+	if (handle == -1) {
+		return;
+	}
+
+	LitValue key = OBJECT_VALUE(key_names[handle]);
+
+	if (batch_key_events) {
+		lit_values_write(tsab_get_state(), &batch->values, key);
+	} else {
+		tsab_call_method(method, &key, 1);
+	}
+}
+
+/*
+ * The arrays are reused every frame, so the callbacks have to copy them, if they want to keep them around
+ */
+static void flush_key_events(LitArray* batch, LitString* method) {
+	if (batch->values.count == 0) {
+		return;
+	}
+
+	LitValue keys = OBJECT_VALUE(batch);
+
+	tsab_call_method(method, &keys, 1);
+	batch->values.count = 0;
+}
+
+void tsab_input_update() {
+	int count = 0;
+	const Uint8* keyboard = SDL_GetKeyboardState(&count);
+
+	memcpy(input_previous_keyboard_state, input_current_keyboard_state, 512);
+	memcpy(input_current_keyboard_state, keyboard, std::min(count, 512));
+
+	// A click, that was released before this update, still counts as down for one frame
+	memcpy(input_previous_mouse_state, input_current_mouse_state, 12);
+
 	for (int i = 0; i < 12; i++) {
-		input_previous_mouse_state[i] = input_current_mouse_state[i];
-		input_current_mouse_state[i] = 0;
+		input_current_mouse_state[i] = input_mouse_held[i] | input_mouse_events[i];
 	}
 
-	for (int i = 0; i < 24; i++) {
-		input_previous_gamepad_button_state[i] = input_current_gamepad_button_state[i];
+	memset(input_mouse_events, 0, 12);
+
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		ControllerSlot* slot = &controllers[i];
+
+		if (slot->controller != nullptr) {
+			slot->previous = slot->current;
+			slot->current = slot->live;
+		}
 	}
 
-	if (controller != nullptr) {
-		for (int i = SDL_CONTROLLER_BUTTON_INVALID; i < SDL_CONTROLLER_BUTTON_MAX; i++) {
-			input_current_gamepad_button_state[i] = SDL_GameControllerGetButton(controller, (SDL_GameControllerButton) i);
+	update_actions();
+
+	flush_key_events(pressed_keys, key_pressed_string);
+	flush_key_events(released_keys, key_released_string);
+}
+
+static void record_event(Uint32 time, int handle, int player, bool pressed) {
+	if (handle < 0) {
+		return;
+	}
+
+	event_buffer[event_count & (INPUT_EVENT_BUFFER_SIZE - 1)] = { time, (uint16_t) handle, (int8_t) player, pressed };
+	event_count++;
+}
+
+static int get_mouse_button(Uint8 button) {
+	switch (button) {
+		case SDL_BUTTON_LEFT: return MOUSE_1;
+		case SDL_BUTTON_RIGHT: return MOUSE_2;
+		case SDL_BUTTON_MIDDLE: return MOUSE_3;
+		case SDL_BUTTON_X1: return MOUSE_4;
+		case SDL_BUTTON_X2: return MOUSE_5;
+		default: return -1;
+	}
+}
+
+static ControllerSlot* find_controller(SDL_JoystickID id) {
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		if (controllers[i].controller != nullptr && controllers[i].id == id) {
+			return &controllers[i];
 		}
+	}
+
+	return nullptr;
+}
 
-		for (int i = SDL_CONTROLLER_AXIS_INVALID; i < SDL_CONTROLLER_AXIS_MAX; i++) {
-			input_gamepad_axis_state[i] = SDL_GameControllerGetAxis(controller, (SDL_GameControllerAxis) i);
+static void open_controller(int device_index) {
+	SDL_GameController* controller = SDL_GameControllerOpen(device_index);
+
+	if (controller == nullptr) {
+		std::cerr << "Failed to connect controller: " << SDL_GetError() << "\n";
+		return;
+	}
+
+	SDL_JoystickID id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller));
+	int player = -1;
+
+	// Opening an already open controller only bumps its reference count
+	if (find_controller(id) != nullptr) {
+		SDL_GameControllerClose(controller);
+		return;
+	}
+
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		if (controllers[i].controller == nullptr) {
+			player = i;
+			break;
 		}
 	}
 
-	input_current_keyboard_state = SDL_GetKeyboardState(nullptr);
+	if (player == -1) {
+		std::cout << "All " << INPUT_MAX_CONTROLLERS << " controller slots are taken\n";
+		SDL_GameControllerClose(controller);
+
+		return;
+	}
+
+	ControllerSlot* slot = &controllers[player];
+	memset(slot, 0, sizeof(ControllerSlot));
+
+	slot->controller = controller;
+	slot->id = id;
+
+	// Buttons, that were held while plugging in, won't send an event
+	for (int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; i++) {
+		slot->live.buttons[i] = SDL_GameControllerGetButton(controller, (SDL_GameControllerButton) i);
+	}
+
+	for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+		slot->live.axes[i] = SDL_GameControllerGetAxis(controller, (SDL_GameControllerAxis) i);
+	}
+
+	std::cout << "Registered controller " << player << "\n";
+
+	LitValue value = NUMBER_VALUE(player);
+	tsab_call_method(controller_connected_string, &value, 1);
+}
+
+static void close_controller(SDL_JoystickID id) {
+	ControllerSlot* slot = find_controller(id);
+
+	if (slot == nullptr) {
+		return;
+	}
+
+	int player = slot - controllers;
+
+	SDL_GameControllerClose(slot->controller);
+	memset(slot, 0, sizeof(ControllerSlot));
+
+	std::cout << "Removed controller " << player << "\n";
+
+	LitValue value = NUMBER_VALUE(player);
+	tsab_call_method(controller_disconnected_string, &value, 1);
 }
 
 void tsab_input_handle_event(SDL_Event *event) {
 	switch (event->type) {
-		case SDL_MOUSEBUTTONDOWN: {
-			if (event->button.button == SDL_BUTTON_LEFT) input_current_mouse_state[MOUSE_1] = 1;
-			if (event->button.button == SDL_BUTTON_RIGHT) input_current_mouse_state[MOUSE_2] = 1;
-			if (event->button.button == SDL_BUTTON_MIDDLE) input_current_mouse_state[MOUSE_3] = 1;
-			if (event->button.button == SDL_BUTTON_X1) input_current_mouse_state[MOUSE_4] = 1;
-			if (event->button.button == SDL_BUTTON_X2) input_current_mouse_state[MOUSE_5] = 1;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP: {
+			int button = get_mouse_button(event->button.button);
+
+			if (button != -1) {
+				bool pressed = event->type == SDL_MOUSEBUTTONDOWN;
+
+				input_mouse_held[button] = pressed ? 1 : 0;
+				input_mouse_events[button] |= pressed ? 1 : 0;
+
+				record_event(event->button.timestamp, mouse_handles[button], -1, pressed);
+			}
 
 			break;
 		}
 
 		case SDL_MOUSEWHEEL: {
-			if (event->wheel.x == 1) input_current_mouse_state[MOUSE_WHEEL_RIGHT] = 1;
-			if (event->wheel.x == -1) input_current_mouse_state[MOUSE_WHEEL_LEFT] = 1;
-			if (event->wheel.y == 1) input_current_mouse_state[MOUSE_WHEEL_DOWN] = 1;
-			if (event->wheel.y == -1) input_current_mouse_state[MOUSE_WHEEL_UP] = 1;
+			int button = -1;
+
+			if (event->wheel.x == 1) button = MOUSE_WHEEL_RIGHT;
+			if (event->wheel.x == -1) button = MOUSE_WHEEL_LEFT;
+			if (event->wheel.y == 1) button = MOUSE_WHEEL_DOWN;
+			if (event->wheel.y == -1) button = MOUSE_WHEEL_UP;
+
+			if (button != -1) {
+				input_mouse_events[button] = 1;
+				record_event(event->wheel.timestamp, mouse_handles[button], -1, true);
+			}
 
 			break;
 		}
 
-		case SDL_JOYDEVICEADDED:
 		case SDL_CONTROLLERDEVICEADDED: {
-			if (controller == nullptr) {
-				controller = SDL_GameControllerOpen(event->cdevice.which);
-
-				if (controller == nullptr) {
-					std::cerr << "Failed to connect controller: " << SDL_GetError() << "\n";
-				} else {
-					std::cout << "Registered controller\n";
-					tsab_call_method("controllerConnected", nullptr, 0);
-				}
+			open_controller(event->cdevice.which);
+			break;
+		}
+
+		case SDL_CONTROLLERDEVICEREMOVED: {
+			close_controller(event->cdevice.which);
+			break;
+		}
+
+		case SDL_CONTROLLERBUTTONDOWN:
+		case SDL_CONTROLLERBUTTONUP: {
+			ControllerSlot* slot = find_controller(event->cbutton.which);
+
+			if (slot != nullptr && event->cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+				bool pressed = event->type == SDL_CONTROLLERBUTTONDOWN;
+
+				slot->live.buttons[event->cbutton.button] = pressed ? 1 : 0;
+				record_event(event->cbutton.timestamp, controller_handles[event->cbutton.button], slot - controllers, pressed);
 			}
 
 			break;
 		}
 
-		case SDL_JOYDEVICEREMOVED:
-		case SDL_CONTROLLERDEVICEREMOVED: {
-			if (controller == reinterpret_cast<SDL_GameController *>(event->cdevice.which)) {
-				controller = nullptr;
-				std::cout << "Removed controller\n";
-				tsab_call_method("controllerDisconnected", nullptr, 0);
+		case SDL_CONTROLLERAXISMOTION: {
+			ControllerSlot* slot = find_controller(event->caxis.which);
+
+			if (slot != nullptr && event->caxis.axis < SDL_CONTROLLER_AXIS_MAX) {
+				slot->live.axes[event->caxis.axis] = event->caxis.value;
 			}
 
 			break;
 		}
 
 		case SDL_KEYDOWN: {
-			auto name = key_names.find(event->key.keysym.scancode);
-
-			if (name != key_names.end()) {
-				LitValue key = OBJECT_VALUE(lit_copy_string(tsab_get_state(), name->second.c_str(), name->second.length()));
-				tsab_call_method("keyPressed", &key, 1);
+			if (!event->key.repeat && event->key.keysym.scancode < 512) {
+				record_event(event->key.timestamp, keyboard_handles[event->key.keysym.scancode], -1, true);
 			}
 
+			send_key_event(event->key.keysym.scancode, pressed_keys, key_pressed_string);
+
 			break;
 		}
 
 		case SDL_KEYUP: {
-			auto name = key_names.find(event->key.keysym.scancode);
-
-			if (name != key_names.end()) {
-				LitValue key = OBJECT_VALUE(lit_copy_string(tsab_get_state(), name->second.c_str(), name->second.length()));
-				tsab_call_method("keyReleased", &key, 1);
+			if (event->key.keysym.scancode < 512) {
+				record_event(event->key.timestamp, keyboard_handles[event->key.keysym.scancode], -1, false);
 			}
 
+			send_key_event(event->key.keysym.scancode, released_keys, key_released_string);
+
 			break;
 		}
 	}
 }
 
+/*
+ * Every key name gets interned once and is kept alive by Input.keyNames. Lit interns all of its strings,
+ * so a string argument either is one of those objects, or isn't a key at all
+ */
+static InputKey* find_key(LitVm* vm, uint arg_count, LitValue* args) {
+	if (arg_count > 0 && IS_NUMBER(args[0])) {
+		int handle = AS_NUMBER(args[0]);
+
+		if (handle >= 0 && handle < (int) keys.size()) {
+			return &keys[handle];
+		}
+
+		std::cout << "No such key handle " << handle << std::endl;
+		return nullptr;
+	}
+
+	LitString* name = LIT_CHECK_OBJECT_STRING(0);
+	auto it = key_handles.find(name);
+
+	if (it == key_handles.end()) {
+		std::cout << "No such key " << name->chars << std::endl;
+		return nullptr;
+	}
+
+	return &keys[it->second];
+}
+
+LIT_METHOD(input_key) {
+	LitString* name = LIT_CHECK_OBJECT_STRING(0);
+	auto it = key_handles.find(name);
+
+	if (it == key_handles.end()) {
+		std::cout << "No such key " << name->chars << std::endl;
+		return NULL_VALUE;
+	}
+
+	return NUMBER_VALUE(it->second);
+}
+
+/*
+ * getAxis(axis, player)
+ */
 LIT_METHOD(input_get_axis) {
-	if (controller == nullptr) {
+	InputKey* key = find_key(vm, arg_count, args);
+
+	if (key == nullptr) {
 		return FALSE_VALUE;
 	}
 
-	const char *axis = LIT_CHECK_STRING(0);
-	auto it = key_map.find(axis);
-
-	if (it != key_map.end()) {
-		return NUMBER_VALUE(std::max<double>(-1, ((double) input_gamepad_axis_state[it->second]) / 32767));
-	} else {
-		std::cout << "No such axis " << axis << std::endl;
+	if (key->device != INPUT_AXIS) {
+		std::cout << "No such axis " << key_list[key - keys.data()] << std::endl;
 		return FALSE_VALUE;
 	}
+
+	bool connected;
+	float value = get_axis_value(key->code, LIT_GET_NUMBER(1, -1), &connected);
+
+	return connected ? NUMBER_VALUE(value) : FALSE_VALUE;
+}
+
+LIT_METHOD(input_get_controller_count) {
+	int count = 0;
+
+	for (int i = 0; i < INPUT_MAX_CONTROLLERS; i++) {
+		if (controllers[i].controller != nullptr) {
+			count++;
+		}
+	}
+
+	return NUMBER_VALUE(count);
+}
+
+LIT_METHOD(input_is_controller_connected) {
+	int player = LIT_CHECK_NUMBER(0);
+	return BOOL_VALUE(player >= 0 && player < INPUT_MAX_CONTROLLERS && controllers[player].controller != nullptr);
 }
 
 LIT_METHOD(input_mouse_x) {
@@ -294,138 +693,436 @@ LIT_METHOD(input_mouse_y) {
 }
 
 LIT_METHOD(input_was_released) {
-	const char *key = LIT_CHECK_STRING(0);
+	InputKey* key = find_key(vm, arg_count, args);
 
-	if (strstr(key, "controller") != nullptr) {
-		if (controller == nullptr) {
-			return FALSE_VALUE;
-		}
+	if (key == nullptr) {
+		return FALSE_VALUE;
+	}
 
-		auto it = key_map.find(key);
+	return BOOL_VALUE(test_key(key, LIT_GET_NUMBER(1, -1), KEY_RELEASED));
+}
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
+LIT_METHOD(input_is_down) {
+	InputKey* key = find_key(vm, arg_count, args);
 
-			return BOOL_VALUE(input_current_gamepad_button_state[scancode] == 0 && input_previous_gamepad_button_state[scancode] == 1);
-		} else {
-			std::cout << "No such control " << key << std::endl;
-			return FALSE_VALUE;
-		}
-	} else if (strstr(key, "mouse") != nullptr) {
-		auto it = key_map.find(key);
+	if (key == nullptr) {
+		return FALSE_VALUE;
+	}
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
+	return BOOL_VALUE(test_key(key, LIT_GET_NUMBER(1, -1), KEY_DOWN));
+}
 
-			return BOOL_VALUE(input_current_mouse_state[scancode] == 0 && input_previous_mouse_state[scancode] == 1);
-		} else {
-			std::cout << "No such mouse control " << key << std::endl;
-			return FALSE_VALUE;
-		}
+LIT_METHOD(input_was_pressed) {
+	InputKey* key = find_key(vm, arg_count, args);
+
+	if (key == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(test_key(key, LIT_GET_NUMBER(1, -1), KEY_PRESSED));
+}
+
+/*
+ * events(out)
+ * Fills the array with every event since the last call, flat, 4 values per event: key handle, pressed, time in ms and player
+ */
+LIT_METHOD(input_events) {
+	LitState* state = vm->state;
+	LitArray* result;
+
+	if (arg_count > 0 && IS_ARRAY(args[0])) {
+		result = AS_ARRAY(args[0]);
 	} else {
-		auto it = key_map.find(key);
+		result = lit_create_array(state);
+	}
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
-			return BOOL_VALUE(input_current_keyboard_state[scancode] == 0 && input_previous_keyboard_state[scancode] == 1);
-		} else {
-			std::cout << "No such key " << key << std::endl;
-			return FALSE_VALUE;
-		}
+	lit_push_root(state, (LitObject*) result);
+	result->values.count = 0;
+
+	// Whatever got overwritten before anyone read it is lost
+	if (event_count - event_read > INPUT_EVENT_BUFFER_SIZE) {
+		event_read = event_count - INPUT_EVENT_BUFFER_SIZE;
+	}
+
+	for (; event_read < event_count; event_read++) {
+		InputEvent* event = &event_buffer[event_read & (INPUT_EVENT_BUFFER_SIZE - 1)];
+
+		lit_values_write(state, &result->values, NUMBER_VALUE(event->key));
+		lit_values_write(state, &result->values, BOOL_VALUE(event->pressed));
+		lit_values_write(state, &result->values, NUMBER_VALUE(event->time));
+		lit_values_write(state, &result->values, NUMBER_VALUE(event->player));
 	}
 
-	return FALSE_VALUE;
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
 }
 
-LIT_METHOD(input_is_down) {
-	const char *key = LIT_CHECK_STRING(0);
+/*
+ * Walks the buffer back from the newest event, until the events get too old
+ */
+static bool happened_within(InputKey* key, Uint32 ms, int player, bool pressed) {
+	int handle = key - keys.data();
+	Uint32 now = SDL_GetTicks();
+	Uint32 since = now > ms ? now - ms : 0;
+	uint64_t oldest = event_count > INPUT_EVENT_BUFFER_SIZE ? event_count - INPUT_EVENT_BUFFER_SIZE : 0;
+
+	for (uint64_t i = event_count; i > oldest; i--) {
+		InputEvent* event = &event_buffer[(i - 1) & (INPUT_EVENT_BUFFER_SIZE - 1)];
+
+		if (event->time < since) {
+			break;
+		}
 
-	if (strstr(key, "controller") != nullptr) {
-		if (controller == nullptr) {
-			return FALSE_VALUE;
+		if (event->key == handle && event->pressed == pressed && (player < 0 || event->player == player)) {
+			return true;
 		}
+	}
 
-		auto it = key_map.find(key);
+	return false;
+}
 
-		if (it != key_map.end()) {
-			return BOOL_VALUE(input_current_gamepad_button_state[it->second] == 1);
-		} else {
-			std::cout << "No such control " << key << std::endl;
-			return FALSE_VALUE;
+/*
+ * pressedWithin(key, ms, player)
+ */
+LIT_METHOD(input_pressed_within) {
+	InputKey* key = find_key(vm, arg_count, args);
+
+	if (key == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(happened_within(key, LIT_CHECK_NUMBER(1), LIT_GET_NUMBER(2, -1), true));
+}
+
+LIT_METHOD(input_released_within) {
+	InputKey* key = find_key(vm, arg_count, args);
+
+	if (key == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(happened_within(key, LIT_CHECK_NUMBER(1), LIT_GET_NUMBER(2, -1), false));
+}
+
+static int find_key_by_name(const char* name, uint length) {
+	for (uint i = 0; i < key_list.size(); i++) {
+		if (strlen(key_list[i]) == length && strncmp(key_list[i], name, length) == 0) {
+			return i;
 		}
-	} else if (strstr(key, "mouse") != nullptr) {
-		auto it = key_map.find(key);
+	}
 
-		if (it != key_map.end()) {
-			return BOOL_VALUE(input_current_mouse_state[it->second] == 1);
-		} else {
-			std::cout << "No such mouse control " << key << std::endl;
-			return FALSE_VALUE;
+	return -1;
+}
+
+/*
+ * Takes a key handle or a name, axis names can end with + or - to only count that direction
+ */
+static bool parse_binding(LitValue value, ActionBinding* binding) {
+	int handle = -1;
+	binding->direction = 0;
+
+	if (IS_NUMBER(value)) {
+		handle = AS_NUMBER(value);
+	} else if (IS_STRING(value)) {
+		LitString* name = AS_STRING(value);
+		uint length = name->length;
+		char last = length > 1 ? name->chars[length - 1] : '\0';
+
+		if (last == '+' || last == '-') {
+			binding->direction = last == '+' ? 1 : -1;
+			length--;
 		}
+
+		handle = find_key_by_name(name->chars, length);
+	}
+
+	if (handle < 0 || handle >= (int) keys.size()) {
+		return false;
+	}
+
+	binding->key = keys[handle];
+	return binding->direction == 0 || binding->key.device == INPUT_AXIS;
+}
+
+static InputAction* find_action(LitVm* vm, uint arg_count, LitValue* args, int* handle) {
+	int id = -1;
+
+	if (arg_count > 0 && IS_NUMBER(args[0])) {
+		id = AS_NUMBER(args[0]);
 	} else {
-		auto it = key_map.find(key);
+		auto it = action_handles.find(LIT_CHECK_OBJECT_STRING(0));
 
-		if (it != key_map.end()) {
-			return BOOL_VALUE(input_current_keyboard_state[it->second] == 1);
-		} else {
-			std::cout << "No such key " << key << std::endl;
-			return FALSE_VALUE;
+		if (it != action_handles.end()) {
+			id = it->second;
 		}
 	}
 
-	return FALSE_VALUE;
+	if (id < 0 || id >= (int) actions.size()) {
+		return nullptr;
+	}
+
+	if (handle != nullptr) {
+		*handle = id;
+	}
+
+	return &actions[id];
 }
 
-LIT_METHOD(input_was_pressed) {
-	const char *key = LIT_CHECK_STRING(0);
+/*
+ * bind(action, inputs, deadzone, player)
+ * inputs is a single input or an array of them, binding an action again replaces its inputs,
+ * the player limits the controller inputs to that controller slot
+ */
+LIT_METHOD(input_bind) {
+	LitString* name = LIT_CHECK_OBJECT_STRING(0);
 
-	if (strstr(key, "controller") != nullptr) {
-		if (controller == nullptr) {
-			return FALSE_VALUE;
-		}
+	if (arg_count < 2) {
+		lit_runtime_error_exiting(vm, "Expected input or array of inputs as argument #2");
+	}
 
-		auto it = key_map.find(key);
+	int handle;
+	auto it = action_handles.find(name);
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
-			return BOOL_VALUE(input_current_gamepad_button_state[scancode] == 1 && input_previous_gamepad_button_state[scancode] == 0);
-		} else {
-			std::cout << "No such control " << key << std::endl;
-			return FALSE_VALUE;
+	if (it == action_handles.end()) {
+		if (actions.size() >= INPUT_MAX_ACTIONS) {
+			lit_runtime_error_exiting(vm, "Can't have more than %i actions", INPUT_MAX_ACTIONS);
 		}
-	} else if (strstr(key, "mouse") != nullptr) {
-		auto it = key_map.find(key);
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
-			return BOOL_VALUE(input_current_mouse_state[scancode] == 1 && input_previous_mouse_state[scancode] == 0);
-		} else {
-			std::cout << "No such mouse control " << key << std::endl;
-			return FALSE_VALUE;
-		}
+		handle = actions.size();
+		actions.push_back({});
+
+		action_handles[name] = handle;
+		action_names.push_back(name);
+
+		tsab_keep_alive((LitObject*) name);
 	} else {
-		auto it = key_map.find(key);
+		handle = it->second;
+	}
 
-		if (it != key_map.end()) {
-			int scancode = it->second;
-			return BOOL_VALUE(input_current_keyboard_state[scancode] == 1 && input_previous_keyboard_state[scancode] == 0);
-		} else {
-			std::cout << "No such key " << key << std::endl;
-			return FALSE_VALUE;
+	InputAction* action = &actions[handle];
+
+	action->bindings.clear();
+	action->deadzone = LIT_GET_NUMBER(2, INPUT_DEFAULT_DEADZONE);
+	action->player = LIT_GET_NUMBER(3, -1);
+
+	uint count = 1;
+	LitValue* inputs = &args[1];
+
+	if (IS_ARRAY(args[1])) {
+		LitValues* values = &AS_ARRAY(args[1])->values;
+
+		count = values->count;
+		inputs = values->values;
+	}
+
+	for (uint i = 0; i < count; i++) {
+		ActionBinding binding;
+
+		if (!parse_binding(inputs[i], &binding)) {
+			lit_runtime_error_exiting(vm, "Invalid input #%i for action %s", i + 1, name->chars);
+		}
+
+		action->bindings.push_back(binding);
+	}
+
+	return NUMBER_VALUE(handle);
+}
+
+LIT_METHOD(input_unbind) {
+	InputAction* action = find_action(vm, arg_count, args, nullptr);
+
+	if (action != nullptr) {
+		action->bindings.clear();
+		action->value = 0;
+	}
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(input_action) {
+	int handle;
+
+	if (find_action(vm, arg_count, args, &handle) == nullptr) {
+		return NULL_VALUE;
+	}
+
+	return NUMBER_VALUE(handle);
+}
+
+LIT_METHOD(input_get_bindings) {
+	InputAction* action = find_action(vm, arg_count, args, nullptr);
+
+	if (action == nullptr) {
+		return NULL_VALUE;
+	}
+
+	LitState* state = vm->state;
+	LitArray* result = lit_create_array(state);
+	lit_push_root(state, (LitObject*) result);
+
+	for (auto & binding : action->bindings) {
+		int handle = 0;
+
+		for (uint i = 0; i < keys.size(); i++) {
+			if (keys[i].device == binding.key.device && keys[i].code == binding.key.code) {
+				handle = i;
+				break;
+			}
 		}
+
+		char name[64];
+		int length = snprintf(name, sizeof(name), "%s%s", key_list[handle], binding.direction == 0 ? "" : (binding.direction > 0 ? "+" : "-"));
+
+		lit_values_write(state, &result->values, OBJECT_VALUE(lit_copy_string(state, name, length)));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+LIT_METHOD(input_is_action_down) {
+	int handle;
+
+	if (find_action(vm, arg_count, args, &handle) == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(test_bit(actions_current, handle));
+}
+
+LIT_METHOD(input_was_action_pressed) {
+	int handle;
+
+	if (find_action(vm, arg_count, args, &handle) == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(test_bit(actions_current, handle) && !test_bit(actions_previous, handle));
+}
+
+LIT_METHOD(input_was_action_released) {
+	int handle;
+
+	if (find_action(vm, arg_count, args, &handle) == nullptr) {
+		return FALSE_VALUE;
+	}
+
+	return BOOL_VALUE(!test_bit(actions_current, handle) && test_bit(actions_previous, handle));
+}
+
+LIT_METHOD(input_get_action_value) {
+	InputAction* action = find_action(vm, arg_count, args, nullptr);
+	return NUMBER_VALUE(action == nullptr ? 0 : action->value);
+}
+
+static LitValue copy_names(LitState* state, const std::vector<LitString*>& names) {
+	LitArray* result = lit_create_array(state);
+
+	lit_push_root(state, (LitObject*) result);
+
+	for (LitString* name : names) {
+		lit_values_write(state, &result->values, OBJECT_VALUE(name));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+/*
+ * A copy, indexed by the key handles
+ */
+LIT_METHOD(input_key_names) {
+	return copy_names(vm->state, key_names);
+}
+
+/*
+ * A copy, indexed by the action handles
+ */
+LIT_METHOD(input_action_names) {
+	return copy_names(vm->state, action_names);
+}
+
+LIT_METHOD(input_batch_key_events_get) {
+	return BOOL_VALUE(batch_key_events);
+}
+
+LIT_METHOD(input_batch_key_events_set) {
+	batch_key_events = LIT_CHECK_BOOL(0);
+
+	// Deliver whatever got collected, so that nothing gets lost or sent twice
+	if (!batch_key_events) {
+		flush_key_events(pressed_keys, key_pressed_string);
+		flush_key_events(released_keys, key_released_string);
 	}
 
-	return FALSE_VALUE;
+	return NULL_VALUE;
 }
 
 void tsab_input_bind_api(LitState* state) {
+	// Everything, that the callbacks need, gets created once
+	key_pressed_string = CONST_STRING(state, "keyPressed");
+	tsab_keep_alive((LitObject*) key_pressed_string);
+	key_released_string = CONST_STRING(state, "keyReleased");
+	tsab_keep_alive((LitObject*) key_released_string);
+	controller_connected_string = CONST_STRING(state, "controllerConnected");
+	tsab_keep_alive((LitObject*) controller_connected_string);
+	controller_disconnected_string = CONST_STRING(state, "controllerDisconnected");
+	tsab_keep_alive((LitObject*) controller_disconnected_string);
+
+	pressed_keys = lit_create_array(state);
+	tsab_keep_alive((LitObject*) pressed_keys);
+	released_keys = lit_create_array(state);
+	tsab_keep_alive((LitObject*) released_keys);
+
+	batch_key_events = false;
+
+	key_handles.clear();
+	action_handles.clear();
+	action_names.clear();
+	actions.clear();
+
+	memset(actions_current, 0, sizeof(actions_current));
+	memset(actions_previous, 0, sizeof(actions_previous));
+
+	event_read = event_count;
+
+	key_names.clear();
+
+	for (uint i = 0; i < key_list.size(); i++) {
+		LitString* name = CONST_STRING(state, key_list[i]);
+
+		tsab_keep_alive((LitObject*) name);
+		key_names.push_back(name);
+		key_handles[name] = i;
+	}
+
 	LIT_BEGIN_CLASS("Input")
 		LIT_BIND_STATIC_GETTER("mouseX", input_mouse_x);
 		LIT_BIND_STATIC_GETTER("mouseY", input_mouse_y);
 
+		LIT_BIND_STATIC_METHOD("key", input_key);
 		LIT_BIND_STATIC_METHOD("isDown", input_is_down);
 		LIT_BIND_STATIC_METHOD("wasReleased", input_was_released);
 		LIT_BIND_STATIC_METHOD("wasPressed", input_was_pressed);
 		LIT_BIND_STATIC_METHOD("getAxis", input_get_axis);
+		LIT_BIND_STATIC_METHOD("events", input_events);
+		LIT_BIND_STATIC_METHOD("pressedWithin", input_pressed_within);
+		LIT_BIND_STATIC_METHOD("releasedWithin", input_released_within);
+
+		LIT_BIND_STATIC_METHOD("getControllerCount", input_get_controller_count);
+		LIT_BIND_STATIC_METHOD("isControllerConnected", input_is_controller_connected);
+
+		LIT_BIND_STATIC_METHOD("bind", input_bind);
+		LIT_BIND_STATIC_METHOD("unbind", input_unbind);
+		LIT_BIND_STATIC_METHOD("action", input_action);
+		LIT_BIND_STATIC_METHOD("getBindings", input_get_bindings);
+		LIT_BIND_STATIC_METHOD("isActionDown", input_is_action_down);
+		LIT_BIND_STATIC_METHOD("wasActionPressed", input_was_action_pressed);
+		LIT_BIND_STATIC_METHOD("wasActionReleased", input_was_action_released);
+		LIT_BIND_STATIC_METHOD("getActionValue", input_get_action_value);
+		LIT_BIND_STATIC_GETTER("actionNames", input_action_names);
+
+		LIT_BIND_STATIC_GETTER("keyNames", input_key_names);
+		LIT_BIND_STATIC_FIELD("batchKeyEvents", input_batch_key_events_get, input_batch_key_events_set);
 	LIT_END_CLASS()
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <tsab/tsab_profiler.hpp>
+
+#include <SDL.h>
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+typedef struct {
+	float entries[PROFILER_PHASE_COUNT + PROFILER_MAX_SCOPES];
+} ProfilerFrame;
+
+typedef struct {
+	int scope;
+	Uint64 start;
+} OpenScope;
+
+static const char* phase_names[PROFILER_PHASE_COUNT] = {
+	"events", "loader", "update", "physics", "render", "flip", "sleep", "frame"
+};
+
+static ProfilerFrame frames[PROFILER_FRAMES];
+static int current_frame = 0;
+static int recorded_frames = 0;
+static bool enabled = true;
+
+static double ms_per_tick;
+static Uint64 phase_start[PROFILER_PHASE_COUNT];
+
+static std::vector<std::string> scope_names;
+static std::unordered_map<std::string, int> scope_ids;
+static std::vector<OpenScope> open_scopes;
+
+static inline float elapsed(Uint64 start) {
+	return (SDL_GetPerformanceCounter() - start) * ms_per_tick;
+}
+
+void tsab_profiler_begin_frame() {
+	if (!enabled) {
+		return;
+	}
+
+	if (ms_per_tick == 0) {
+		ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+	}
+
+	current_frame = (current_frame + 1) % PROFILER_FRAMES;
+	recorded_frames = fmin(recorded_frames + 1, PROFILER_FRAMES);
+
+	memset(&frames[current_frame], 0, sizeof(ProfilerFrame));
+	phase_start[PROFILER_FRAME] = SDL_GetPerformanceCounter();
+}
+
+void tsab_profiler_end_frame() {
+	if (!enabled || ms_per_tick == 0) {
+		return;
+	}
+
+	auto frame = &frames[current_frame];
+
+	// Scopes, that lit forgot to close, end with the frame
+	while (!open_scopes.empty()) {
+		auto scope = open_scopes.back();
+		open_scopes.pop_back();
+
+		frame->entries[PROFILER_PHASE_COUNT + scope.scope] += elapsed(scope.start);
+	}
+
+	frame->entries[PROFILER_FRAME] = elapsed(phase_start[PROFILER_FRAME]);
+}
+
+void tsab_profiler_begin(ProfilerPhase phase) {
+	if (enabled) {
+		phase_start[phase] = SDL_GetPerformanceCounter();
+	}
+}
+
+void tsab_profiler_end(ProfilerPhase phase) {
+	if (enabled && ms_per_tick != 0) {
+		frames[current_frame].entries[phase] += elapsed(phase_start[phase]);
+	}
+}
+
+int tsab_profiler_get_entry_count() {
+	return PROFILER_PHASE_COUNT + scope_names.size();
+}
+
+const char* tsab_profiler_get_entry_name(int entry) {
+	if (entry < PROFILER_PHASE_COUNT) {
+		return phase_names[entry];
+	}
+
+	return scope_names[entry - PROFILER_PHASE_COUNT].c_str();
+}
+
+float tsab_profiler_get_average(int entry, int count) {
+	count = fmin(count, recorded_frames);
+
+	if (count <= 0 || entry < 0 || entry >= tsab_profiler_get_entry_count()) {
+		return 0;
+	}
+
+	float total = 0;
+
+	for (int i = 0; i < count; i++) {
+		total += frames[(current_frame - i + PROFILER_FRAMES) % PROFILER_FRAMES].entries[entry];
+	}
+
+	return total / count;
+}
+
+int tsab_profiler_get_history(int entry, float* out, int count) {
+	count = fmin(count, recorded_frames);
+
+	if (entry < 0 || entry >= tsab_profiler_get_entry_count()) {
+		return 0;
+	}
+
+	for (int i = 0; i < count; i++) {
+		out[i] = frames[(current_frame - count + 1 + i + PROFILER_FRAMES) % PROFILER_FRAMES].entries[entry];
+	}
+
+	return count;
+}
+
+static int find_entry(LitVm* vm, const char* name, bool create) {
+	for (int i = 0; i < PROFILER_PHASE_COUNT; i++) {
+		if (strcmp(phase_names[i], name) == 0) {
+			return i;
+		}
+	}
+
+	auto iterator = scope_ids.find(name);
+
+	if (iterator != scope_ids.end()) {
+		return PROFILER_PHASE_COUNT + iterator->second;
+	}
+
+	if (!create) {
+		return -1;
+	}
+
+	if (scope_names.size() >= PROFILER_MAX_SCOPES) {
+		lit_runtime_error_exiting(vm, "Too many profiler scopes (max is %i)", PROFILER_MAX_SCOPES);
+	}
+
+	int id = scope_names.size();
+
+	scope_names.push_back(name);
+	scope_ids[name] = id;
+
+	return PROFILER_PHASE_COUNT + id;
+}
+
+/*
+ * API
+ */
+
+LIT_METHOD(profiler_begin) {
+	const char* name = LIT_CHECK_STRING(0);
+	int entry = find_entry(vm, name, true);
+
+	if (entry < PROFILER_PHASE_COUNT) {
+		lit_runtime_error_exiting(vm, "Profiler scope '%s' clashes with a frame phase", name);
+	}
+
+	if (enabled) {
+		open_scopes.push_back((OpenScope) { entry - PROFILER_PHASE_COUNT, SDL_GetPerformanceCounter() });
+	}
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(profiler_end) {
+	if (open_scopes.empty()) {
+		return NULL_VALUE;
+	}
+
+	auto scope = open_scopes.back();
+	open_scopes.pop_back();
+
+	if (enabled && ms_per_tick != 0) {
+		frames[current_frame].entries[PROFILER_PHASE_COUNT + scope.scope] += elapsed(scope.start);
+	}
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(profiler_get_time) {
+	int entry = find_entry(vm, LIT_CHECK_STRING(0), false);
+
+	if (entry == -1) {
+		return NULL_VALUE;
+	}
+
+	return NUMBER_VALUE(tsab_profiler_get_average(entry, LIT_GET_NUMBER(1, 1)));
+}
+
+LIT_METHOD(profiler_get_history) {
+	int entry = find_entry(vm, LIT_CHECK_STRING(0), false);
+
+	if (entry == -1) {
+		return NULL_VALUE;
+	}
+
+	LitState* state = vm->state;
+	LitArray* array;
+
+	if (arg_count > 1 && IS_ARRAY(args[1])) {
+		array = AS_ARRAY(args[1]);
+		array->values.count = 0;
+	} else {
+		array = lit_create_array(state);
+	}
+
+	float history[PROFILER_FRAMES];
+	int count = tsab_profiler_get_history(entry, history, PROFILER_FRAMES);
+
+	lit_push_root(state, (LitObject*) array);
+
+	for (int i = 0; i < count; i++) {
+		lit_values_write(state, &array->values, NUMBER_VALUE(history[i]));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(array);
+}
+
+LIT_METHOD(profiler_enabled_get) {
+	return BOOL_VALUE(enabled);
+}
+
+LIT_METHOD(profiler_enabled_set) {
+	enabled = LIT_CHECK_BOOL(0);
+	open_scopes.clear();
+
+	return NULL_VALUE;
+}
+
+void tsab_profiler_bind_api(LitState* state) {
+	LIT_BEGIN_CLASS("Profiler")
+		LIT_BIND_STATIC_METHOD("begin", profiler_begin)
+		LIT_BIND_STATIC_METHOD("end", profiler_end)
+		LIT_BIND_STATIC_METHOD("getTime", profiler_get_time)
+		LIT_BIND_STATIC_METHOD("getHistory", profiler_get_history)
+
+		LIT_BIND_STATIC_FIELD("enabled", profiler_enabled_get, profiler_enabled_set)
+	LIT_END_CLASS()
+}
\ No newline at end of file
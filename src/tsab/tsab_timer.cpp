@@ -0,0 +1,271 @@
+#include <tsab/tsab_timer.hpp>
+#include <tsab/tsab.hpp>
+
+#include <SDL.h>
+
+#include <math.h>
+#include <string.h>
+
+static VsyncMode vsync = VSYNC_ON;
+static float target_fps = TIMER_DEFAULT_FPS;
+static float refresh_period = 0; // In seconds, 0 if the display didn't tell us
+
+static Uint64 frequency;
+static Uint64 start_counter;
+static Uint64 last_frame;
+static Uint64 next_frame;
+
+static float delta = 1.0f / TIMER_DEFAULT_FPS;
+static float fps = TIMER_DEFAULT_FPS;
+
+static TimerStats stats;
+// Field names of the getStats() object, kept alive with tsab_keep_alive()
+static LitString* stats_fields[4];
+static double total_time;
+
+void tsab_timer_configure(LitState* state, LitInstance* config) {
+	if (config == nullptr) {
+		return;
+	}
+
+	LitValue l = lit_get_field(state, &config->fields, "loop");
+
+	if (!IS_INSTANCE(l)) {
+		return;
+	}
+
+	LitTable* loop_map = &AS_INSTANCE(l)->fields;
+	LitValue value;
+
+	if (IS_NUMBER(value = lit_get_field(state, loop_map, "fps"))) {
+		target_fps = fmax(0, AS_NUMBER(value));
+	}
+
+	value = lit_get_field(state, loop_map, "vsync");
+
+	if (IS_BOOL(value)) {
+		vsync = AS_BOOL(value) ? VSYNC_ON : VSYNC_OFF;
+	} else if (IS_STRING(value) && strcmp(AS_CSTRING(value), "adaptive") == 0) {
+		vsync = VSYNC_ADAPTIVE;
+	}
+}
+
+void tsab_timer_set_vsync(VsyncMode mode) {
+	vsync = mode;
+
+	#ifndef EMSCRIPTEN
+		// Adaptive vsync isn't supported by every driver, regular vsync is the next best thing
+		if (mode != VSYNC_ADAPTIVE || SDL_GL_SetSwapInterval(-1) != 0) {
+			if (mode == VSYNC_ADAPTIVE) {
+				vsync = VSYNC_ON;
+			}
+
+			SDL_GL_SetSwapInterval(vsync == VSYNC_OFF ? 0 : 1);
+		}
+	#endif
+
+	SDL_DisplayMode display_mode;
+
+	if (SDL_GetCurrentDisplayMode(0, &display_mode) == 0 && display_mode.refresh_rate > 0) {
+		refresh_period = 1.0f / display_mode.refresh_rate;
+	} else {
+		refresh_period = 0;
+	}
+}
+
+/*
+ * With vsync on, there is no point in capping at or above the refresh rate, the swap already waits for us
+ */
+static bool is_capped() {
+	if (target_fps <= 0) {
+		return false;
+	}
+
+	return vsync == VSYNC_OFF || refresh_period == 0 || 1.0f / target_fps > refresh_period * 1.01f;
+}
+
+void tsab_timer_set_fps(float fps) {
+	target_fps = fmax(0, fps);
+
+	if (frequency != 0 && target_fps > 0) {
+		next_frame = SDL_GetPerformanceCounter() + frequency / target_fps;
+	}
+}
+
+void tsab_timer_start() {
+	frequency = SDL_GetPerformanceFrequency();
+	start_counter = last_frame = SDL_GetPerformanceCounter();
+
+	tsab_timer_set_vsync(vsync);
+	tsab_timer_set_fps(target_fps);
+}
+
+static void sleep_until(Uint64 target) {
+	Uint64 spin = TIMER_SPIN_MS * frequency / 1000;
+	Uint64 current = SDL_GetPerformanceCounter();
+
+	if (target > current + spin) {
+		SDL_Delay((Uint32) ((target - current - spin) * 1000 / frequency));
+	}
+
+	while (SDL_GetPerformanceCounter() < target) {
+		// Spin for the rest
+	}
+}
+
+float tsab_timer_wait() {
+	Uint64 current = SDL_GetPerformanceCounter();
+	bool capped = is_capped();
+	bool missed = false;
+
+	// The browser paces the main loop for us, blocking it would only stall the page
+	#ifndef EMSCRIPTEN
+		if (capped) {
+			Uint64 period = frequency / target_fps;
+
+			if (current < next_frame) {
+				sleep_until(next_frame);
+
+				current = SDL_GetPerformanceCounter();
+				next_frame += period;
+			} else {
+				missed = true;
+				// More than a whole frame behind, don't try to catch up with a burst of short frames
+				next_frame = current - next_frame > period ? current + period : next_frame + period;
+			}
+		}
+	#endif
+
+	delta = (double) (current - last_frame) / frequency;
+	last_frame = current;
+	fps = delta > 0 ? 1.0f / delta : 0;
+
+	if (!capped && vsync != VSYNC_OFF && refresh_period > 0) {
+		missed = delta > refresh_period * 1.5f;
+	}
+
+	float ms = delta * 1000.0f;
+	total_time += ms;
+
+	stats.frames++;
+	stats.missed += missed ? 1 : 0;
+	stats.worst = fmax(stats.worst, ms);
+	stats.average = total_time / stats.frames;
+
+	return delta;
+}
+
+float tsab_timer_get_delta() {
+	return delta;
+}
+
+float tsab_timer_get_fps() {
+	return fps;
+}
+
+double tsab_timer_get_time() {
+	if (frequency == 0) {
+		return 0;
+	}
+
+	return (double) (SDL_GetPerformanceCounter() - start_counter) / frequency;
+}
+
+TimerStats* tsab_timer_get_stats() {
+	return &stats;
+}
+
+/*
+ * API
+ */
+
+LIT_METHOD(timer_get_time) {
+	return NUMBER_VALUE(tsab_timer_get_time());
+}
+
+LIT_METHOD(timer_get_stats) {
+	LitState* state = vm->state;
+	LitInstance* result;
+
+	if (arg_count > 0 && IS_INSTANCE(args[0])) {
+		result = AS_INSTANCE(args[0]);
+	} else {
+		result = lit_create_instance(state, state->object_class);
+	}
+
+	double values[4] = { (double) stats.frames, (double) stats.missed, stats.worst, stats.average };
+
+	lit_push_root(state, (LitObject*) result);
+
+	for (int i = 0; i < 4; i++) {
+		lit_table_set(state, &result->fields, stats_fields[i], NUMBER_VALUE(values[i]));
+	}
+
+	lit_pop_root(state);
+	return OBJECT_VALUE(result);
+}
+
+LIT_METHOD(timer_reset_stats) {
+	memset(&stats, 0, sizeof(TimerStats));
+	total_time = 0;
+
+	return NULL_VALUE;
+}
+
+LIT_METHOD(timer_delta) {
+	return NUMBER_VALUE(delta);
+}
+
+LIT_METHOD(timer_fps) {
+	return NUMBER_VALUE(fps);
+}
+
+LIT_METHOD(timer_target_fps_get) {
+	return NUMBER_VALUE(target_fps);
+}
+
+LIT_METHOD(timer_target_fps_set) {
+	tsab_timer_set_fps(LIT_CHECK_NUMBER(0));
+	return NULL_VALUE;
+}
+
+LIT_METHOD(timer_vsync_get) {
+	if (vsync == VSYNC_ADAPTIVE) {
+		return OBJECT_CONST_STRING(vm->state, "adaptive");
+	}
+
+	return BOOL_VALUE(vsync == VSYNC_ON);
+}
+
+LIT_METHOD(timer_vsync_set) {
+	LIT_ENSURE_ARGS(1)
+
+	if (IS_STRING(args[0]) && strcmp(AS_CSTRING(args[0]), "adaptive") == 0) {
+		tsab_timer_set_vsync(VSYNC_ADAPTIVE);
+	} else {
+		tsab_timer_set_vsync(LIT_CHECK_BOOL(0) ? VSYNC_ON : VSYNC_OFF);
+	}
+
+	return NULL_VALUE;
+}
+
+void tsab_timer_bind_api(LitState* state) {
+	const char* fields[4] = { "frames", "missed", "worst", "average" };
+
+	for (int i = 0; i < 4; i++) {
+		stats_fields[i] = CONST_STRING(state, fields[i]);
+		tsab_keep_alive((LitObject*) stats_fields[i]);
+	}
+
+	LIT_BEGIN_CLASS("Timer")
+		LIT_BIND_STATIC_METHOD("getTime", timer_get_time)
+		LIT_BIND_STATIC_METHOD("getStats", timer_get_stats)
+		LIT_BIND_STATIC_METHOD("resetStats", timer_reset_stats)
+
+		LIT_BIND_STATIC_GETTER("delta", timer_delta)
+		LIT_BIND_STATIC_GETTER("fps", timer_fps)
+
+		LIT_BIND_STATIC_FIELD("targetFps", timer_target_fps_get, timer_target_fps_set)
+		LIT_BIND_STATIC_FIELD("vsync", timer_vsync_get, timer_vsync_set)
+	LIT_END_CLASS()
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <tsab/tsab_ui.hpp>
+#include <tsab/tsab_profiler.hpp>
 
 #include <SDL.h>
 #include "SDL_gpu.h"
@@ -7,6 +8,8 @@
 #include "imgui/examples/imgui_impl_sdl.h"
 #include "imgui/examples/imgui_impl_opengl3.h"
 
+static bool initialized = false;
+
 void tsab_ui_init() {
 	#if __APPLE__
 		// GL 3.2 Core + GLSL 150
@@ -32,9 +35,14 @@ void tsab_ui_init() {
 	ImGui::StyleColorsDark();
 
 	ImGui::GetStyle().FrameRounding = 5;
+	initialized = true;
 }
 
 void tsab_ui_quit() {
+	if (!initialized) {
+		return;
+	}
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplSDL2_Shutdown();
 	ImGui::DestroyContext();
@@ -420,43 +428,86 @@ LIT_METHOD(ui_same_line) {
 	return NULL_VALUE;
 }
 
+/*
+ * Window with the frame time graph and the average time of every phase and scope
+ */
+LIT_METHOD(ui_profiler) {
+	const char* name = LIT_GET_STRING(0, "Profiler");
+	int frames = LIT_GET_NUMBER(1, 60);
+
+	ImGui::SetNextWindowBgAlpha(0.8f);
+
+	if (!ImGui::Begin(name, nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+		ImGui::End();
+		return NULL_VALUE;
+	}
+
+	float history[PROFILER_FRAMES];
+	int count = tsab_profiler_get_history(PROFILER_FRAME, history, PROFILER_FRAMES);
+	float frame_time = tsab_profiler_get_average(PROFILER_FRAME, frames);
+
+	ImGui::Text("%.2f ms (%.0f fps)", frame_time, frame_time > 0 ? 1000.0f / frame_time : 0.0f);
+	ImGui::PlotLines("##frame", history, count, 0, nullptr, 0, 50, ImVec2(PROFILER_FRAMES, 60));
+	ImGui::Separator();
+
+	for (int i = 0; i < tsab_profiler_get_entry_count(); i++) {
+		if (i != PROFILER_FRAME) {
+			ImGui::Text("%-12s %6.3f ms", tsab_profiler_get_entry_name(i), tsab_profiler_get_average(i, frames));
+		}
+	}
+
+	ImGui::End();
+	return NULL_VALUE;
+}
+
+LIT_METHOD(ui_noop) {
+	return NULL_VALUE;
+}
+
 void tsab_ui_bind_api(LitState* state) {
+	// Without a window there is no ImGui context, so every call turns into a no-op
+	#define UI_METHOD(method) (initialized ? method : ui_noop)
+
 	LIT_BEGIN_CLASS("ImGui")
-		LIT_BIND_STATIC_METHOD("newFrame", ui_new_frame)
-		LIT_BIND_STATIC_METHOD("render", ui_render)
+		LIT_BIND_STATIC_METHOD("newFrame", UI_METHOD(ui_new_frame))
+		LIT_BIND_STATIC_METHOD("render", UI_METHOD(ui_render))
+
+		LIT_BIND_STATIC_METHOD("setNextWindowPosition", UI_METHOD(ui_set_next_window_position))
+		LIT_BIND_STATIC_METHOD("setNextWindowSize", UI_METHOD(ui_set_next_window_size))
 
-		LIT_BIND_STATIC_METHOD("setNextWindowPosition", ui_set_next_window_position)
-		LIT_BIND_STATIC_METHOD("setNextWindowSize", ui_set_next_window_size)
+		LIT_BIND_STATIC_METHOD("begin", UI_METHOD(ui_begin))
+		LIT_BIND_STATIC_METHOD("end", UI_METHOD(ui_end))
+		LIT_BIND_STATIC_METHOD("treeNode", UI_METHOD(ui_tree_node))
+		LIT_BIND_STATIC_METHOD("treePop", UI_METHOD(ui_tree_pop))
 
-		LIT_BIND_STATIC_METHOD("begin", ui_begin)
-		LIT_BIND_STATIC_METHOD("end", ui_end)
-		LIT_BIND_STATIC_METHOD("treeNode", ui_tree_node)
-		LIT_BIND_STATIC_METHOD("treePop", ui_tree_pop)
+		LIT_BIND_STATIC_METHOD("beginPopup", UI_METHOD(ui_begin_popup))
+		LIT_BIND_STATIC_METHOD("endPopup", UI_METHOD(ui_end_popup))
+		LIT_BIND_STATIC_METHOD("openPopup", UI_METHOD(ui_open_popup))
+		LIT_BIND_STATIC_METHOD("closePopup", UI_METHOD(ui_close_popup))
 
-		LIT_BIND_STATIC_METHOD("beginPopup", ui_begin_popup)
-		LIT_BIND_STATIC_METHOD("endPopup", ui_end_popup)
-		LIT_BIND_STATIC_METHOD("openPopup", ui_open_popup)
-		LIT_BIND_STATIC_METHOD("closePopup", ui_close_popup)
+		LIT_BIND_STATIC_METHOD("begin", UI_METHOD(ui_begin))
+		LIT_BIND_STATIC_METHOD("end", UI_METHOD(ui_end))
 
-		LIT_BIND_STATIC_METHOD("begin", ui_begin)
-		LIT_BIND_STATIC_METHOD("end", ui_end)
+		LIT_BIND_STATIC_METHOD("text", UI_METHOD(ui_text))
+		LIT_BIND_STATIC_METHOD("bulletText", UI_METHOD(ui_bullet_text))
+		LIT_BIND_STATIC_METHOD("button", UI_METHOD(ui_button))
+		LIT_BIND_STATIC_METHOD("checkbox", UI_METHOD(ui_checkbox))
 
-		LIT_BIND_STATIC_METHOD("text", ui_text)
-		LIT_BIND_STATIC_METHOD("bulletText", ui_bullet_text)
-		LIT_BIND_STATIC_METHOD("button", ui_button)
-		LIT_BIND_STATIC_METHOD("checkbox", ui_checkbox)
+		LIT_BIND_STATIC_METHOD("inputInt", UI_METHOD(ui_input_int))
+		LIT_BIND_STATIC_METHOD("inputFloat", UI_METHOD(ui_input_float))
+		LIT_BIND_STATIC_METHOD("dragInt", UI_METHOD(ui_drag_int))
+		LIT_BIND_STATIC_METHOD("dragFloat", UI_METHOD(ui_drag_float))
 
-		LIT_BIND_STATIC_METHOD("inputInt", ui_input_int)
-		LIT_BIND_STATIC_METHOD("inputFloat", ui_input_float)
-		LIT_BIND_STATIC_METHOD("dragInt", ui_drag_int)
-		LIT_BIND_STATIC_METHOD("dragFloat", ui_drag_float)
+		LIT_BIND_STATIC_METHOD("inputInt2", UI_METHOD(ui_input_int2))
+		LIT_BIND_STATIC_METHOD("inputFloat2", UI_METHOD(ui_input_float2))
 
-		LIT_BIND_STATIC_METHOD("inputInt2", ui_input_int2)
-		LIT_BIND_STATIC_METHOD("inputFloat2", ui_input_float2)
+		LIT_BIND_STATIC_METHOD("colorEdit", UI_METHOD(ui_color_edit))
 
-		LIT_BIND_STATIC_METHOD("colorEdit", ui_color_edit)
+		LIT_BIND_STATIC_METHOD("separator", UI_METHOD(ui_separator))
+		LIT_BIND_STATIC_METHOD("sameLine", UI_METHOD(ui_same_line))
 
-		LIT_BIND_STATIC_METHOD("separator", ui_separator)
-		LIT_BIND_STATIC_METHOD("sameLine", ui_same_line)
+		LIT_BIND_STATIC_METHOD("profiler", UI_METHOD(ui_profiler))
 	LIT_END_CLASS()
+
+	#undef UI_METHOD
 }
\ No newline at end of file
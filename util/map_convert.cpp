@@ -0,0 +1,168 @@
+#define CUTE_TILED_IMPLEMENTATION
+#define STRPOOL_EMBEDDED_IMPLEMENTATION
+
+#include "cute_tiled.h"
+#include <tsab/graphics/tsab_map_format.hpp>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+static std::vector<char> strings;
+static std::unordered_map<std::string, uint32_t> string_offsets;
+
+static uint32_t add_string(const char* str) {
+	if (str == NULL) {
+		str = "";
+	}
+
+	auto iterator = string_offsets.find(str);
+
+	if (iterator != string_offsets.end()) {
+		return iterator->second;
+	}
+
+	uint32_t offset = strings.size();
+
+	strings.insert(strings.end(), str, str + strlen(str) + 1);
+	string_offsets[str] = offset;
+
+	return offset;
+}
+
+// Same order as the runtime loader, layers from groups get flattened in place
+static void collect_layers(cute_tiled_layer_t* layer, std::vector<cute_tiled_layer_t*>& tile_layers, std::vector<cute_tiled_layer_t*>& object_layers) {
+	while (layer != NULL) {
+		if (layer->layers != NULL) {
+			collect_layers(layer->layers, tile_layers, object_layers);
+		} else if (layer->data != NULL) {
+			tile_layers.push_back(layer);
+		} else if (layer->objects != NULL) {
+			object_layers.push_back(layer);
+		}
+
+		layer = layer->next;
+	}
+}
+
+static void write_or_exit(FILE* out, const void* data, size_t size, const char* fname) {
+	if (size > 0 && fwrite(data, size, 1, out) != 1) {
+		perror(fname);
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		fprintf(stderr, "USAGE: %s {map.json} {out}\n\n  Converts a Tiled JSON map into the binary tsab map format\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	cute_tiled_map_t* map = cute_tiled_load_map_from_file(argv[1], NULL);
+
+	if (map == NULL) {
+		fprintf(stderr, "Failed to load map %s: %s\n", argv[1], cute_tiled_error_reason);
+		return EXIT_FAILURE;
+	}
+
+	printf("Converting map %s...\n", argv[1]);
+
+	std::vector<cute_tiled_layer_t*> tile_layers;
+	std::vector<cute_tiled_layer_t*> object_layers;
+
+	collect_layers(map->layers, tile_layers, object_layers);
+
+	std::vector<MapFileTileset> tilesets;
+	cute_tiled_tileset_t* tileset = map->tilesets;
+
+	while (tileset != NULL) {
+		tilesets.push_back((MapFileTileset) {
+			add_string(tileset->name.ptr), add_string(tileset->image.ptr),
+			(uint32_t) tileset->firstgid, (uint32_t) tileset->tilecount, (uint32_t) tileset->columns,
+			(uint32_t) tileset->tilewidth, (uint32_t) tileset->tileheight, (uint32_t) tileset->margin, (uint32_t) tileset->spacing
+		});
+
+		tileset = tileset->next;
+	}
+
+	std::vector<MapFileObject> objects;
+
+	for (auto layer : object_layers) {
+		cute_tiled_object_t* object = layer->objects;
+		uint32_t layer_name = add_string(layer->name.ptr);
+
+		while (object != NULL) {
+			objects.push_back((MapFileObject) {
+				layer_name, add_string(object->name.ptr), add_string(object->type.ptr),
+				object->x, object->y, object->width, object->height
+			});
+
+			object = object->next;
+		}
+	}
+
+	uint32_t layer_size = map->width * map->height * sizeof(uint32_t);
+
+	MapFileHeader header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic = TSAB_MAP_MAGIC;
+	header.version = TSAB_MAP_VERSION;
+	header.width = map->width;
+	header.height = map->height;
+	header.tile_width = map->tilewidth;
+	header.tile_height = map->tileheight;
+	header.tileset_count = tilesets.size();
+	header.layer_count = tile_layers.size();
+	header.object_count = objects.size();
+	header.tilesets_offset = sizeof(MapFileHeader);
+	header.layers_offset = header.tilesets_offset + tilesets.size() * sizeof(MapFileTileset);
+	header.objects_offset = header.layers_offset + tile_layers.size() * sizeof(MapFileLayer);
+
+	uint32_t tiles_offset = header.objects_offset + objects.size() * sizeof(MapFileObject);
+	std::vector<MapFileLayer> layers;
+
+	for (size_t i = 0; i < tile_layers.size(); i++) {
+		cute_tiled_layer_t* layer = tile_layers[i];
+
+		if (layer->data_count != map->width * map->height) {
+			fprintf(stderr, "Layer %s does not cover the whole map (infinite maps are not supported)\n", layer->name.ptr);
+			return EXIT_FAILURE;
+		}
+
+		layers.push_back((MapFileLayer) {
+			add_string(layer->name.ptr), (uint32_t) (layer->visible != 0), (uint32_t) (tiles_offset + i * layer_size)
+		});
+	}
+
+	header.strings_offset = tiles_offset + tile_layers.size() * layer_size;
+	header.strings_size = strings.size();
+
+	FILE* out = fopen(argv[2], "wb");
+
+	if (out == NULL) {
+		perror(argv[2]);
+		return EXIT_FAILURE;
+	}
+
+	write_or_exit(out, &header, sizeof(header), argv[2]);
+	write_or_exit(out, tilesets.data(), tilesets.size() * sizeof(MapFileTileset), argv[2]);
+	write_or_exit(out, layers.data(), layers.size() * sizeof(MapFileLayer), argv[2]);
+	write_or_exit(out, objects.data(), objects.size() * sizeof(MapFileObject), argv[2]);
+
+	for (auto layer : tile_layers) {
+		// Gids keep their flip flags, so they have to be stored unsigned
+		write_or_exit(out, layer->data, layer_size, argv[2]);
+	}
+
+	write_or_exit(out, strings.data(), strings.size(), argv[2]);
+
+	fclose(out);
+	cute_tiled_free_map(map);
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file